@@ -24,10 +24,12 @@
 #include <stdlib.h>
 #include <string.h>
 
-#include "bit_ops.h"
 #include "bytearray.h"
+#include "candidate.h"
 #include "hex.h"
+#include "histogram.h"
 #include "score.h"
+#include "topk.h"
 
 /* Challenge-Specific Constants */
 
@@ -37,6 +39,9 @@ const char *input_hexstr  = "1b37373331363f78151b7f2b783431333d78397828372d363c7
 
 #define MIN_ENGLISH_TEXT_SCORE 0.1
 
+/* The most candidates we print */
+#define TOP_CANDIDATE_COUNT 5
+
 int
 main(int argc, const char * argv[])
 {
@@ -53,42 +58,45 @@ main(int argc, const char * argv[])
   char *input_escstr = bytearray_to_escstr(input_bytearray);
   printf("Escaped Bytes:       %s\n", input_escstr);
 
+  /* XOR only permutes the byte histogram, so every different XOR value can
+   * be scored from the input histogram */
+  byte_histogram_t input_histogram;
+  bytearray_histogram(input_bytearray, &input_histogram);
+
+  /* Stop scoring each XOR value as soon as it can't reach the minimum */
+  double scores[BYTE_VALUE_COUNT];
+  score_english_histogram_all_keys_bounded(&input_histogram,
+                                           MIN_ENGLISH_TEXT_SCORE, scores);
+
+  /* Keep the best candidates, and render them after the search */
+  topk_t *top_candidates = topk_alloc(TOP_CANDIDATE_COUNT);
+
   /* Try every different XOR value
    * use do ... while to get every single byte value in the loop */
   uint8_t byte = 0;
   do {
-    bytearray_t *output_bytearray = bytearray_xor_byte(input_bytearray, byte);
-
-    double score = score_english_text(output_bytearray);
-
-    if (score >= MIN_ENGLISH_TEXT_SCORE) {
-      /* Bytes -> Hex */
-      printf("XOR Byte:              %hhu %c 0x%hhx\n", byte, byte, byte);
-      printf("Overall Score:         %.3f\n", score);
-
-      char *output_hexstr = bytearray_to_hexstr(output_bytearray);
-      printf("Hex XOR:               %s\n", output_hexstr);
-
-      /*printf("Bytes XOR:             %s\n", (char *)output_bytearray->bytes);
-       */
-
-      char *output_escstr = bytearray_to_escstr(output_bytearray);
-      printf("Escaped Bytes XOR:     %s\n", output_escstr);
-      printf("\n");
-
-      /* Cleanup conditional loop allocations */
-      free(output_hexstr);
-      free(output_escstr);
+    if (scores[byte] >= MIN_ENGLISH_TEXT_SCORE) {
+      topk_offer(top_candidates, 0, byte, scores[byte]);
     }
 
-    /* Cleanup loop allocations */
-    bytearray_free(output_bytearray);
-
     byte++;
 
     /* rely on unsigned integer wrapping to 0 on overflow to exit the loop */
   } while (byte != 0);
 
+  topk_entry_t winners[TOP_CANDIDATE_COUNT];
+  size_t winner_count = topk_sorted(top_candidates, winners,
+                                    TOP_CANDIDATE_COUNT);
+
+  for (size_t i = 0; i < winner_count; i++) {
+    /* Only decrypt the candidates we print */
+    const candidate_t winner = candidate_from_topk_entry(&winners[i],
+                                                         input_bytearray);
+    candidate_print(&winner);
+  }
+
+  topk_free(top_candidates);
+
   /* Cleanup input allocations */
   bytearray_free(input_bytearray);
   free(input_escstr);
@@ -21,15 +21,19 @@
 //
 
 #include <assert.h>
+#include <limits.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <string.h>
-#include <sys/param.h>
 
-#include "bit_ops.h"
 #include "bytearray.h"
+#include "candidate.h"
+#include "detect.h"
+#include "dictionary.h"
 #include "hex.h"
+#include "parallel.h"
 #include "score.h"
+#include "topk.h"
 
 /* Challenge-Specific Constants */
 
@@ -41,94 +45,151 @@ const char *input_file_path  = "4.txt";
 
 #define MIN_ENGLISH_TEXT_SCORE 0.1
 
-#define MAX_LINE_LENGTH 1024
+/* The word list only has common words, so allow for some uncommon ones.
+ * At least this fraction of the letters in a candidate must be in
+ * dictionary words. */
+#define MIN_WORD_SCORE 0.3
 
-int
-main(int argc, const char * argv[])
-{
-  /* Unused */
-  (void)argc;
-  (void)argv;
-
-  /* Open the file */
-  FILE *f = fopen(input_file_path, "r");
-  assert(f != NULL);
+/* The most candidates we print */
+#define TOP_CANDIDATE_COUNT 5
 
-  while (!feof(f)) {
+/* The first stage keeps more candidates than we print, so candidates that
+ * fail the word check can be replaced by the next best ones */
+#define STAGE1_CANDIDATE_COUNT 64
 
-    /* Read each line from the file */
-    char input_hexstr[MAX_LINE_LENGTH];
-    char *result = NULL;
+/* Read the hex characters at located from f, and return them as a new
+ * string. The detector has already split the lines, so we don't look for
+ * newlines.
+ * The caller must free the string. */
+static char *
+read_located_hexstr(FILE *f, const detect_line_t *located)
+{
+  assert(located->offset <= LONG_MAX);
 
-    result = fgets(input_hexstr, MAX_LINE_LENGTH, f);
-    if (result == NULL) {
-      assert(!ferror(f));
-      /* on EOF, exit the loop */
-      break;
-    }
+  int rv = fseek(f, (long)located->offset, SEEK_SET);
+  assert(rv == 0);
 
-    /* Strip the trailing newline character(s) */
-    char *final_char = &input_hexstr[strlen(input_hexstr) - 1];
-    while (final_char >= input_hexstr
-           && !is_hexchar_valid(*final_char, HEXCHAR_ACCEPT_ANY_CASE)) {
-      *final_char = 0;
-      final_char--;
-    }
+  char *hexstr = malloc(located->length + 1);
+  assert(hexstr != NULL);
 
-    /* Skip zero-length strings */
-    if (strlen(input_hexstr) == 0) {
-      continue;
-    }
+  size_t read_length = fread(hexstr, 1, located->length, f);
+  assert(read_length == located->length);
+  hexstr[located->length] = 0;
 
-    /* Check if it decrypts to English text with any XOR value */
-    bytearray_t *input_bytearray = hexstr_to_bytearray(input_hexstr);
+  return hexstr;
+}
 
-    /* Try every different XOR value
-     * use do ... while to get every single byte value in the loop */
-    uint8_t byte = 0;
-    do {
-      bytearray_t *output_bytearray = bytearray_xor_byte(input_bytearray, byte);
+/* A candidate that passed both stages, and the index of its line in the
+ * surviving lines */
+typedef struct winner_t {
+  cascade_result_t result;
+  size_t line_index;
+} winner_t;
+
+/* Is winner better than other?
+ * Uses the cascade ranking, and breaks ties by earlier lines.
+ * A topk_better_func. */
+static bool
+is_winner_better(const void *winner, const void *other)
+{
+  const winner_t * const winner_a = winner;
+  const winner_t * const winner_b = other;
+
+  if (is_cascade_result_better(&winner_a->result, &winner_b->result)) {
+    return true;
+  } else if (is_cascade_result_better(&winner_b->result, &winner_a->result)) {
+    return false;
+  } else {
+    return winner_a->line_index < winner_b->line_index;
+  }
+}
 
-      double score = score_english_text(output_bytearray);
+int
+main(int argc, const char * argv[])
+{
+  /* Unused */
+  (void)argc;
+  (void)argv;
 
-      if (score >= MIN_ENGLISH_TEXT_SCORE) {
-        printf("Hex:                 %s\n", input_hexstr);
+  /* Stage 1: keep the best candidates from every line */
+  topk_t *top_candidates = topk_alloc(STAGE1_CANDIDATE_COUNT);
 
-        char *input_escstr = bytearray_to_escstr(input_bytearray);
-        printf("Escaped Bytes:       %s\n", input_escstr);
+  /* Find the surviving lines. A line can survive with several keys, but
+   * stage 2 ranks all its keys at once. */
+  detect_line_t lines[STAGE1_CANDIDATE_COUNT];
+  size_t line_count = 0;
 
-        /* Bytes -> Hex */
-        printf("XOR Byte:              %hhu %c 0x%hhx\n", byte, byte, byte);
-        printf("Overall Score:         %.3f\n", score);
+  /* Search the lines in parallel, using every CPU */
+  bool found = detect_xor_lines_file(input_file_path, MIN_ENGLISH_TEXT_SCORE,
+                                     PARALLEL_THREADS_AUTO, top_candidates,
+                                     lines, &line_count);
+  assert(found);
+  topk_free(top_candidates);
 
-        char *output_hexstr = bytearray_to_hexstr(output_bytearray);
-        printf("Hex XOR:               %s\n", output_hexstr);
+  FILE *f = fopen(input_file_path, "r");
+  assert(f != NULL);
 
-        /*printf("Bytes XOR:             %s\n", (char *)output_bytearray->bytes);
-         */
+  char *line_hexstrs[STAGE1_CANDIDATE_COUNT];
+  for (size_t i = 0; i < line_count; i++) {
+    line_hexstrs[i] = read_located_hexstr(f, &lines[i]);
+  }
 
-        char *output_escstr = bytearray_to_escstr(output_bytearray);
-        printf("Escaped Bytes XOR:     %s\n", output_escstr);
-        printf("\n");
+  /* The "Copy Files" build phase ensures the word list is in the products
+   * directory */
+  dictionary_t *dictionary = dictionary_load(DICTIONARY_DEFAULT_PATH);
+  assert(dictionary != NULL);
+
+  /* Stage 2: only check the surviving lines for real words, and keep the
+   * best ones that have enough */
+  bytearray_t *line_bytearrays[STAGE1_CANDIDATE_COUNT];
+  winner_t winners[TOP_CANDIDATE_COUNT];
+  size_t winner_count = 0;
+
+  for (size_t i = 0; i < line_count; i++) {
+    line_bytearrays[i] = hexstr_to_bytearray(line_hexstrs[i]);
+
+    cascade_result_t results[TOP_CANDIDATE_COUNT];
+    const size_t result_count = cascade_rank_keys(dictionary,
+                                                  line_bytearrays[i],
+                                                  MIN_ENGLISH_TEXT_SCORE,
+                                                  MIN_WORD_SCORE, results,
+                                                  TOP_CANDIDATE_COUNT);
+
+    for (size_t j = 0; j < result_count; j++) {
+      const winner_t winner = { results[j], i };
+      winner_count = topk_insert_sorted(winners, winner_count,
+                                        TOP_CANDIDATE_COUNT,
+                                        sizeof(*winners), &winner,
+                                        &is_winner_better);
+    }
+  }
 
-        /* Cleanup conditional loop allocations */
-        free(input_escstr);
-        free(output_hexstr);
-        free(output_escstr);
-      }
+  for (size_t i = 0; i < winner_count; i++) {
+    const size_t line_index = winners[i].line_index;
+    const candidate_t winner = {
+      line_bytearrays[line_index],
+      winners[i].result.key,
+      winners[i].result.score
+    };
 
-      /* Cleanup loop allocations */
-      bytearray_free(output_bytearray);
+    printf("Hex:                 %s\n", line_hexstrs[line_index]);
 
-      byte++;
+    char *input_escstr = bytearray_to_escstr(line_bytearrays[line_index]);
+    printf("Escaped Bytes:       %s\n", input_escstr);
+    free(input_escstr);
 
-      /* rely on unsigned integer wrapping to 0 on overflow to exit the loop */
-    } while (byte != 0);
+    /* Only decrypt the candidates we print */
+    candidate_print(&winner);
+  }
 
-    /* Cleanup input allocations */
-    bytearray_free(input_bytearray);
+  /* Cleanup line allocations */
+  for (size_t i = 0; i < line_count; i++) {
+    free(line_hexstrs[i]);
+    bytearray_free(line_bytearrays[i]);
   }
 
+  dictionary_free(dictionary);
+
   /* Close the file */
   int rv = fclose(f);
   assert(rv == 0);
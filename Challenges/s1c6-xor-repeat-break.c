@@ -29,6 +29,8 @@
 #include "bit_ops.h"
 #include "bytearray.h"
 #include "base64.h"
+#include "breaker.h"
+#include "keysize.h"
 #include "score.h"
 
 /* Challenge-Specific Constants */
@@ -47,6 +49,8 @@ const size_t input_hamming_result = 37;
 
 #define MAX_LINE_LENGTH 1024
 
+#define RANKED_KEYSIZE_COUNT 5
+
 int
 main(int argc, const char * argv[])
 {
@@ -159,53 +163,56 @@ main(int argc, const char * argv[])
   printf("Escaped: %s\n", input_escstr);
   free(input_escstr);
 
-  bytearray_free(input_bytearray);
-
-#if 0
-
-  /* Try every different XOR value
-   * use do ... while to get every single byte value in the loop */
-  uint8_t byte = 0;
-  do {
-    bytearray_t *output_bytearray = bytearray_xor_byte(input_bytearray, byte);
+  /* Rank the likely keysizes */
+  keysize_score_t keysize_scores[RANKED_KEYSIZE_COUNT];
+  size_t keysize_count = keysize_rank_hamming(input_bytearray, NULL,
+                                              keysize_scores,
+                                              RANKED_KEYSIZE_COUNT);
 
-    double score = score_english_text(output_bytearray);
-
-    if (score >= MIN_ENGLISH_TEXT_SCORE) {
-      printf("Hex:                 %s\n", input_base64str);
-
-      char *input_escstr = bytearray_to_escstr(input_bytearray);
-      printf("Escaped Bytes:       %s\n", input_escstr);
+  for (size_t i = 0; i < keysize_count; i++) {
+    printf("Keysize: %2zu Distance: %.3f Pairs: %zu\n",
+           keysize_scores[i].keysize, keysize_scores[i].distance,
+           keysize_scores[i].pair_count);
+  }
 
-      /* Bytes -> Hex */
-      printf("XOR Byte:              %hhu %c 0x%hhx\n", byte, byte, byte);
-      printf("Overall Score:         %.3f\n", score);
+  keysize_count = keysize_rank_coincidence(input_bytearray, NULL,
+                                           keysize_scores,
+                                           RANKED_KEYSIZE_COUNT);
 
-      char *output_hexstr = bytearray_to_hexstr(output_bytearray);
-      printf("Hex XOR:               %s\n", output_hexstr);
+  for (size_t i = 0; i < keysize_count; i++) {
+    printf("Keysize: %2zu Coincidence: %.4f Pairs: %zu\n",
+           keysize_scores[i].keysize, keysize_scores[i].coincidence,
+           keysize_scores[i].pair_count);
+  }
 
-      /*printf("Bytes XOR:             %s\n", (char *)output_bytearray->bytes);
-       */
+  /* Solve the best keysizes, and check each key against the whole
+   * ciphertext */
+  breaker_result_t results[RANKED_KEYSIZE_COUNT];
+  size_t result_count = breaker_break_repeating_xor(input_bytearray, NULL,
+                                                    results,
+                                                    RANKED_KEYSIZE_COUNT);
+
+  for (size_t i = 0; i < result_count; i++) {
+    char *key_escstr = bytearray_to_escstr(results[i].key);
+    printf("Keysize: %2zu Score: %.3f Key: %s\n", results[i].keysize,
+           results[i].score, key_escstr);
+    free(key_escstr);
+  }
 
-      char *output_escstr = bytearray_to_escstr(output_bytearray);
-      printf("Escaped Bytes XOR:     %s\n", output_escstr);
-      printf("\n");
+  /* Only decrypt the best result */
+  if (result_count > 0 && results[0].score >= MIN_ENGLISH_TEXT_SCORE) {
+    bytearray_t *output_bytearray = breaker_result_plaintext(input_bytearray,
+                                                             &results[0]);
 
-      /* Cleanup conditional loop allocations */
-      free(input_escstr);
-      free(output_hexstr);
-      free(output_escstr);
-    }
+    char *output_escstr = bytearray_to_escstr(output_bytearray);
+    printf("Escaped Plaintext: %s\n", output_escstr);
+    free(output_escstr);
 
-    /* Cleanup loop allocations */
     bytearray_free(output_bytearray);
+  }
 
-    byte++;
-
-    /* rely on unsigned integer wrapping to 0 on overflow to exit the loop */
-  } while (byte != 0);
-
-#endif
+  breaker_results_free(results, result_count);
+  bytearray_free(input_bytearray);
 
   return 0;
 }
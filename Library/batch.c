@@ -0,0 +1,595 @@
+//
+//  batch.c
+//  MatasanoCrypto
+//
+//  Created by Tim Wilson-Brown on 18/10/2026.
+//  Copyright © 2026 teor - gmail: teor2345
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "batch.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/param.h>
+
+#include "bytearray.h"
+#include "calc.h"
+#include "cpu.h"
+#include "histogram.h"
+#include "parallel.h"
+#include "score.h"
+
+#if CPU_DISPATCH_X86
+#include <immintrin.h>
+#endif
+
+/* Private Data Types */
+
+/* Many lines of at most line_length bytes, stored as a structure of arrays.
+ * The bytes at each position in every line are stored together: the byte
+ * at position in line index is at bytes[position * stride + index]. So one
+ * load reads the same position in LINE_BATCH_LANE_COUNT consecutive lines.
+ * Bytes past the end of a line, and lanes without a line, are zero. */
+struct line_batch_t {
+  size_t line_length;
+  size_t capacity;
+  /* capacity, rounded up to a whole number of lane groups */
+  size_t stride;
+  size_t count;
+  /* The length of the longest line in the batch. Positions after it are
+   * all padding, so they aren't scored. */
+  size_t max_length;
+  uint8_t *bytes;
+  size_t *lengths;
+  size_t *ids;
+};
+
+/* Allocation */
+
+/* Allocate and return a new, empty batch, which can hold capacity lines of
+ * at most line_length bytes.
+ * The caller must free the batch using line_batch_free(). */
+line_batch_t *
+line_batch_alloc(size_t line_length, size_t capacity)
+{
+  assert(line_length > 0);
+  assert(capacity > 0);
+
+  line_batch_t *batch = malloc(sizeof(*batch));
+  assert(batch != NULL);
+
+  batch->line_length = line_length;
+  batch->capacity = capacity;
+  batch->stride = (ceil_div(capacity, LINE_BATCH_LANE_COUNT)
+                   * LINE_BATCH_LANE_COUNT);
+  batch->count = 0;
+  batch->max_length = 0;
+
+  assert(line_length <= SIZE_T_MAX / batch->stride);
+  batch->bytes = calloc(line_length * batch->stride, sizeof(*batch->bytes));
+  assert(batch->bytes != NULL);
+  batch->lengths = calloc(capacity, sizeof(*batch->lengths));
+  assert(batch->lengths != NULL);
+  batch->ids = calloc(capacity, sizeof(*batch->ids));
+  assert(batch->ids != NULL);
+
+  return batch;
+}
+
+/* Free batch, which was allocated by line_batch_alloc().
+ * Use the line_batch_free() macro, which also sets batch to NULL. */
+void
+line_batch_free_(line_batch_t *batch)
+{
+  if (batch == NULL) {
+    return;
+  }
+
+  free(batch->bytes);
+  free(batch->lengths);
+  free(batch->ids);
+  free(batch);
+}
+
+/* Remove every line from batch, so it can be reused. */
+void
+line_batch_clear(line_batch_t *batch)
+{
+  assert(batch != NULL);
+
+  memset(batch->bytes, 0, batch->max_length * batch->stride);
+  batch->count = 0;
+  batch->max_length = 0;
+}
+
+/* Add the length bytes at bytes to batch, and remember id with them.
+ * length must not be zero, or more than the batch's line length. Shorter
+ * lines are padded with zeroes, so lines with similar lengths can share a
+ * batch.
+ * Returns false if batch is full. */
+bool
+line_batch_add(line_batch_t *batch, const uint8_t *bytes, size_t length,
+               size_t id)
+{
+  assert(batch != NULL);
+  assert(bytes != NULL);
+  assert(length > 0);
+  assert(length <= batch->line_length);
+
+  if (line_batch_is_full(batch)) {
+    return false;
+  }
+
+  const size_t index = batch->count;
+
+  /* Transpose the line into its lane */
+  for (size_t position = 0; position < length; position++) {
+    batch->bytes[position * batch->stride + index] = bytes[position];
+  }
+
+  batch->lengths[index] = length;
+  batch->ids[index] = id;
+  batch->count++;
+  batch->max_length = MAX(batch->max_length, length);
+
+  return true;
+}
+
+/* Accessors */
+
+/* Is batch full? */
+bool
+line_batch_is_full(const line_batch_t *batch)
+{
+  assert(batch != NULL);
+  assert(batch->count <= batch->capacity);
+
+  return batch->count == batch->capacity;
+}
+
+/* Return the number of lines in batch. */
+size_t
+line_batch_count(const line_batch_t *batch)
+{
+  assert(batch != NULL);
+
+  return batch->count;
+}
+
+/* Return the maximum line length in batch. */
+size_t
+line_batch_line_length(const line_batch_t *batch)
+{
+  assert(batch != NULL);
+
+  return batch->line_length;
+}
+
+/* Return the length of the line at index in batch. */
+size_t
+line_batch_length(const line_batch_t *batch, size_t index)
+{
+  assert(batch != NULL);
+  assert(index < batch->count);
+
+  return batch->lengths[index];
+}
+
+/* Return the id of the line at index in batch. */
+size_t
+line_batch_id(const line_batch_t *batch, size_t index)
+{
+  assert(batch != NULL);
+  assert(index < batch->count);
+
+  return batch->ids[index];
+}
+
+/* Copy the line at index in batch to bytes_out, which must have space for
+ * line_batch_length(batch, index) bytes. */
+void
+line_batch_get(const line_batch_t *batch, size_t index, uint8_t *bytes_out)
+{
+  assert(batch != NULL);
+  assert(index < batch->count);
+  assert(bytes_out != NULL);
+
+  for (size_t position = 0; position < batch->lengths[index]; position++) {
+    bytes_out[position] = batch->bytes[position * batch->stride + index];
+  }
+}
+
+/* Count the bytes in the line at index in batch into histogram_out. */
+void
+line_batch_histogram(const line_batch_t *batch, size_t index,
+                     byte_histogram_t *histogram_out)
+{
+  assert(batch != NULL);
+  assert(index < batch->count);
+  assert(histogram_out != NULL);
+
+  byte_histogram_clear(histogram_out);
+
+  for (size_t position = 0; position < batch->lengths[index]; position++) {
+    histogram_out->counts[batch->bytes[position * batch->stride + index]]++;
+  }
+
+  histogram_out->length = batch->lengths[index];
+}
+
+/* Lane Kernel */
+
+/* The printable, letter and space counts of each line in a lane group */
+typedef struct lane_counts_t {
+  size_t printable[LINE_BATCH_LANE_COUNT];
+  size_t letter[LINE_BATCH_LANE_COUNT];
+  size_t space[LINE_BATCH_LANE_COUNT];
+} lane_counts_t;
+
+#if CPU_DISPATCH_X86 && LINE_BATCH_LANE_COUNT == 32
+
+/* The byte counters overflow after this many positions, so they are added
+ * to the full counts this often */
+#define LANE_FLUSH_POSITIONS UINT8_MAX
+
+/* Return a mask of the bytes in v that are at most max, as unsigned bytes. */
+CPU_TARGET("avx2") static inline __m256i
+bytes_at_most_avx2(__m256i v, uint8_t max)
+{
+  return _mm256_cmpeq_epi8(_mm256_min_epu8(v, _mm256_set1_epi8((char)max)),
+                           v);
+}
+
+/* Add the byte counters in v to counts. */
+CPU_TARGET("avx2") static inline void
+flush_lanes_avx2(__m256i v, size_t counts[LINE_BATCH_LANE_COUNT])
+{
+  uint8_t lanes[LINE_BATCH_LANE_COUNT];
+  _mm256_storeu_si256((__m256i *)lanes, v);
+
+  for (size_t lane = 0; lane < LINE_BATCH_LANE_COUNT; lane++) {
+    counts[lane] += lanes[lane];
+  }
+}
+
+/* count_lane_group(), with one vector holding the same position in every
+ * lane. Each comparison mask is -1 in matching lanes, so subtracting it
+ * counts the matches. */
+CPU_TARGET("avx2") static void
+count_lane_group_avx2(const uint8_t *group, size_t stride, size_t line_length,
+                      uint8_t key, lane_counts_t *counts_out)
+{
+  const __m256i key_vector = _mm256_set1_epi8((char)key);
+  const __m256i printable_min = _mm256_set1_epi8(' ');
+  const __m256i case_bit = _mm256_set1_epi8(0x20);
+  const __m256i letter_min = _mm256_set1_epi8('a');
+  const __m256i space = _mm256_set1_epi8(' ');
+
+  for (size_t start = 0; start < line_length;
+       start += LANE_FLUSH_POSITIONS) {
+    const size_t end = (line_length - start < LANE_FLUSH_POSITIONS
+                        ? line_length
+                        : start + LANE_FLUSH_POSITIONS);
+    __m256i printable = _mm256_setzero_si256();
+    __m256i letter = _mm256_setzero_si256();
+    __m256i space_count = _mm256_setzero_si256();
+
+    for (size_t position = start; position < end; position++) {
+      const __m256i v = _mm256_xor_si256(
+                  _mm256_loadu_si256((const __m256i *)&group[position
+                                                             * stride]),
+                  key_vector);
+
+      printable = _mm256_sub_epi8(printable, bytes_at_most_avx2(
+                                  _mm256_sub_epi8(v, printable_min),
+                                  '~' - ' '));
+      letter = _mm256_sub_epi8(letter, bytes_at_most_avx2(
+                               _mm256_sub_epi8(_mm256_or_si256(v, case_bit),
+                                               letter_min),
+                               'z' - 'a'));
+      space_count = _mm256_sub_epi8(space_count, _mm256_cmpeq_epi8(v, space));
+    }
+
+    flush_lanes_avx2(printable, counts_out->printable);
+    flush_lanes_avx2(letter, counts_out->letter);
+    flush_lanes_avx2(space_count, counts_out->space);
+  }
+}
+
+#endif
+
+/* Count the printable, letter and space bytes in the line_length positions
+ * of the lane group at group, XORed with key, into counts_out.
+ * Padding bytes are counted as well. */
+static void
+count_lane_group(const uint8_t *group, size_t stride, size_t line_length,
+                 uint8_t key, lane_counts_t *counts_out)
+{
+  assert(group != NULL);
+  assert(counts_out != NULL);
+
+  memset(counts_out, 0, sizeof(*counts_out));
+
+#if CPU_DISPATCH_X86 && LINE_BATCH_LANE_COUNT == 32
+  if (CPU_SUPPORTS("avx2")) {
+    count_lane_group_avx2(group, stride, line_length, key, counts_out);
+    return;
+  }
+#endif
+
+  /* Each lane's comparison is independent, so compilers can vectorise the
+   * inner loop */
+  for (size_t position = 0; position < line_length; position++) {
+    const uint8_t *column = &group[position * stride];
+
+    for (size_t lane = 0; lane < LINE_BATCH_LANE_COUNT; lane++) {
+      const uint8_t byte = column[lane] ^ key;
+
+      counts_out->printable[lane] += ((uint8_t)(byte - ' ') <= '~' - ' ');
+      counts_out->letter[lane] += ((uint8_t)((byte | 0x20) - 'a')
+                                   <= 'z' - 'a');
+      counts_out->space[lane] += (byte == ' ');
+    }
+  }
+}
+
+/* Key Search */
+
+/* Return the English score of the line at index in batch, XORed with key,
+ * evaluating every factor. Stops early if the score can't reach bound. */
+static double
+score_line_key(const line_batch_t *batch, size_t index, uint8_t key,
+               double bound)
+{
+  english_counts_t counts;
+  english_counts_clear(&counts);
+
+  for (size_t position = 0; position < batch->lengths[index]; position++) {
+    english_counts_add_byte(&counts,
+                            batch->bytes[position * batch->stride + index]
+                            ^ key);
+  }
+
+  return score_english_counts_bounded(&counts, bound, NULL);
+}
+
+/* Score every line in batch, XORed with key, as English text, and place the
+ * scores in scores_out, which has space for line_batch_count(batch) scores.
+ * Each lane group's class counts are found together, in a single pass over
+ * the group. Then only the lines that could reach bound are fully scored.
+ * Like score_english_text_bounded(), lines that can't reach bound get an
+ * upper bound on their score, which is less than bound. */
+void
+line_batch_score_key(const line_batch_t *batch, uint8_t key, double bound,
+                     double *scores_out)
+{
+  assert(batch != NULL);
+  assert(scores_out != NULL || batch->count == 0);
+
+  /* Padding bytes are zero, so they decrypt to key */
+  const size_t pad_printable = is_byte_ascii_printable(key);
+  const size_t pad_letter = is_byte_ascii_letter(key);
+  const size_t pad_space = is_byte_ascii_space(key);
+
+  lane_counts_t lane_counts;
+
+  for (size_t group = 0; group < batch->count;
+       group += LINE_BATCH_LANE_COUNT) {
+    count_lane_group(&batch->bytes[group], batch->stride, batch->max_length,
+                     key, &lane_counts);
+
+    for (size_t lane = 0;
+         lane < LINE_BATCH_LANE_COUNT && group + lane < batch->count;
+         lane++) {
+      const size_t index = group + lane;
+      const size_t padding = batch->max_length - batch->lengths[index];
+
+      english_counts_t counts;
+      counts.length = batch->lengths[index];
+      counts.printable = (lane_counts.printable[lane]
+                          - padding * pad_printable);
+      counts.letter = lane_counts.letter[lane] - padding * pad_letter;
+      counts.space = lane_counts.space[lane] - padding * pad_space;
+
+      score_stop_reason_t stop_reason = SCORE_STOP_COMPLETE;
+      const double upper_bound = score_english_class_counts_bounded(
+                                                                &counts,
+                                                                bound,
+                                                                &stop_reason);
+
+      if (stop_reason == SCORE_STOP_COMPLETE) {
+        scores_out[index] = score_line_key(batch, index, key, bound);
+      } else {
+        scores_out[index] = upper_bound;
+      }
+    }
+  }
+}
+
+/* Score every line in batch, XORed with every key, as English text, and
+ * place the score of line index with key in scores_out[index][key].
+ * Like line_batch_score_key(), scores that can't reach bound are upper
+ * bounds less than bound. */
+void
+line_batch_score_all_keys(const line_batch_t *batch, double bound,
+                          double (*scores_out)[BYTE_VALUE_COUNT])
+{
+  assert(batch != NULL);
+  assert(scores_out != NULL || batch->count == 0);
+
+  double *key_scores = calloc(MAX(batch->count, 1), sizeof(*key_scores));
+  assert(key_scores != NULL);
+
+  /* use do ... while to get every single byte value in the loop */
+  uint8_t key = 0;
+  do {
+    line_batch_score_key(batch, key, bound, key_scores);
+
+    for (size_t index = 0; index < batch->count; index++) {
+      scores_out[index][key] = key_scores[index];
+    }
+
+    key++;
+
+    /* rely on unsigned integer wrapping to 0 on overflow to exit the loop */
+  } while (key != 0);
+
+  free(key_scores);
+}
+
+/* Batch Scoring */
+
+/* Each parallel task scores this many candidates, so that claiming tasks
+ * costs much less than scoring them */
+#define SCORE_BATCH_TASK_CANDIDATES 512
+
+/* Batches smaller than this are scored on the calling thread, because
+ * starting threads would take longer than scoring them */
+#define SCORE_BATCH_PARALLEL_MIN_CANDIDATES 4096
+
+/* The candidates in a batch: either an array of views, or count candidates
+ * of candidate_length bytes, stored contiguously at bytes */
+typedef struct score_batch_t {
+  const byte_view_t *views;
+  const uint8_t *bytes;
+  size_t candidate_length;
+  size_t count;
+  double *scores_out;
+} score_batch_t;
+
+/* Return a view of the candidate at index in batch. */
+static byte_view_t
+score_batch_candidate(const score_batch_t *batch, size_t index)
+{
+  assert(index < batch->count);
+
+  if (batch->views != NULL) {
+    assert(batch->views[index].bytes != NULL);
+    assert(batch->views[index].length > 0);
+    return batch->views[index];
+  }
+
+  byte_view_t view;
+  view.bytes = &batch->bytes[index * batch->candidate_length];
+  view.length = batch->candidate_length;
+  return view;
+}
+
+/* Score the candidates in task index of the score_batch_t context, one lane
+ * group at a time.
+ * A parallel_task_func. */
+static void
+score_batch_task(size_t index, size_t thread_index, void *context)
+{
+  const score_batch_t *batch = context;
+  assert(batch != NULL);
+
+  /* Unused */
+  (void)thread_index;
+
+  const size_t start = index * SCORE_BATCH_TASK_CANDIDATES;
+  const size_t end = (batch->count - start > SCORE_BATCH_TASK_CANDIDATES
+                      ? start + SCORE_BATCH_TASK_CANDIDATES
+                      : batch->count);
+  assert(start < end);
+
+  size_t max_length = 0;
+  for (size_t i = start; i < end; i++) {
+    max_length = MAX(max_length, score_batch_candidate(batch, i).length);
+  }
+
+  line_batch_t *lines = line_batch_alloc(max_length, LINE_BATCH_LANE_COUNT);
+
+  for (size_t first = start; first < end; first += LINE_BATCH_LANE_COUNT) {
+    line_batch_clear(lines);
+
+    for (size_t i = first; i < end && !line_batch_is_full(lines); i++) {
+      const byte_view_t view = score_batch_candidate(batch, i);
+      line_batch_add(lines, view.bytes, view.length, i);
+    }
+
+    /* A zero key leaves the candidates unchanged, and a zero bound only
+     * stops early when the score is zero, like score_english_text() */
+    line_batch_score_key(lines, 0, 0.0, &batch->scores_out[first]);
+  }
+
+  line_batch_free(lines);
+}
+
+/* Score every candidate in batch, using up to thread_count threads. */
+static void
+score_batch_run(score_batch_t *batch, size_t thread_count)
+{
+  assert(batch != NULL);
+
+  if (batch->count < SCORE_BATCH_PARALLEL_MIN_CANDIDATES) {
+    thread_count = 1;
+  }
+
+  const size_t task_count = ceil_div(batch->count,
+                                     SCORE_BATCH_TASK_CANDIDATES);
+  parallel_for(task_count, thread_count, &score_batch_task, batch);
+}
+
+/* Score each of the count candidates in candidates, as if it was passed to
+ * score_english_text(), and place the results in scores_out.
+ * scores_out[i] is the score for candidates[i].
+ * Candidates are copied into line batches, and scored a lane group at a
+ * time.
+ * Uses up to thread_count threads (see parallel_thread_count()). Pass 1 to
+ * score on the calling thread.
+ * Every candidate must have a non-zero length. */
+void
+score_english_text_batch(const byte_view_t *candidates, size_t count,
+                         double *scores_out, size_t thread_count)
+{
+  assert(candidates != NULL || count == 0);
+  assert(scores_out != NULL || count == 0);
+
+  score_batch_t batch;
+  batch.views = candidates;
+  batch.bytes = NULL;
+  batch.candidate_length = 0;
+  batch.count = count;
+  batch.scores_out = scores_out;
+
+  score_batch_run(&batch, thread_count);
+}
+
+/* Score count candidates of candidate_length bytes, stored one after
+ * another at bytes, like score_english_text_batch().
+ * candidate_length must not be zero. */
+void
+score_english_text_batch_contiguous(const uint8_t *bytes,
+                                    size_t candidate_length, size_t count,
+                                    double *scores_out, size_t thread_count)
+{
+  assert(bytes != NULL || count == 0);
+  assert(candidate_length > 0);
+  assert(scores_out != NULL || count == 0);
+
+  score_batch_t batch;
+  batch.views = NULL;
+  batch.bytes = bytes;
+  batch.candidate_length = candidate_length;
+  batch.count = count;
+  batch.scores_out = scores_out;
+
+  score_batch_run(&batch, thread_count);
+}
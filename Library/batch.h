@@ -0,0 +1,79 @@
+//
+//  batch.h
+//  MatasanoCrypto
+//
+//  Created by Tim Wilson-Brown on 18/10/2026.
+//  Copyright © 2026 teor - gmail: teor2345
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef batch_h
+#define batch_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "char.h"
+
+/* Forward Declarations */
+
+typedef struct line_batch_t line_batch_t;
+typedef struct byte_histogram_t byte_histogram_t;
+typedef struct byte_view_t byte_view_t;
+
+/* Batch Constants */
+
+/* Lines are scored in groups of this many lanes. Each lane's counts are
+ * kept next to the other lanes' counts, so the compiler can vectorise the
+ * inner loop. */
+#define LINE_BATCH_LANE_COUNT 32
+
+/* Function Declarations */
+
+line_batch_t *line_batch_alloc(size_t line_length, size_t capacity);
+void line_batch_free_(line_batch_t *batch);
+#define line_batch_free(batch) \
+  do { \
+    line_batch_free_(batch); \
+    batch = NULL; \
+  } while (0)
+
+void line_batch_clear(line_batch_t *batch);
+bool line_batch_add(line_batch_t *batch, const uint8_t *bytes, size_t length,
+                    size_t id);
+bool line_batch_is_full(const line_batch_t *batch);
+size_t line_batch_count(const line_batch_t *batch);
+size_t line_batch_line_length(const line_batch_t *batch);
+size_t line_batch_length(const line_batch_t *batch, size_t index);
+size_t line_batch_id(const line_batch_t *batch, size_t index);
+void line_batch_get(const line_batch_t *batch, size_t index,
+                    uint8_t *bytes_out);
+void line_batch_histogram(const line_batch_t *batch, size_t index,
+                          byte_histogram_t *histogram_out);
+
+void line_batch_score_key(const line_batch_t *batch, uint8_t key,
+                          double bound, double *scores_out);
+void line_batch_score_all_keys(const line_batch_t *batch, double bound,
+                               double (*scores_out)[BYTE_VALUE_COUNT]);
+
+void score_english_text_batch(const byte_view_t *candidates, size_t count,
+                              double *scores_out, size_t thread_count);
+void score_english_text_batch_contiguous(const uint8_t *bytes,
+                                         size_t candidate_length,
+                                         size_t count, double *scores_out,
+                                         size_t thread_count);
+
+#endif /* batch_h */
@@ -22,12 +22,102 @@
 #include "bit_ops.h"
 
 #include <assert.h>
+#include <string.h>
+#include <stdint.h>
 #include <sys/param.h>
 #include <sys/types.h>
 
 #include "bytearray.h"
 
+#include "calc.h"
 #include "char.h"
+#include "cpu.h"
+
+#if CPU_DISPATCH_X86
+#include <immintrin.h>
+#endif
+
+/* XOR length bytes from in with length bytes from pattern, and place the
+ * result in out.
+ * Works a word at a time, so the compiler can vectorise the loop.
+ * out may be the same as in, but must not partially overlap it. */
+static void
+xor_block(uint8_t *out, const uint8_t *in, const uint8_t *pattern,
+          size_t length)
+{
+  size_t i = 0;
+
+  for (i = 0; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t)) {
+    uint64_t data = 0;
+    uint64_t key = 0;
+
+    /* memcpy avoids unaligned access, and compiles to a single load */
+    memcpy(&data, &in[i], sizeof(data));
+    memcpy(&key, &pattern[i], sizeof(key));
+    data ^= key;
+    memcpy(&out[i], &data, sizeof(data));
+  }
+
+  for (; i < length; i++) {
+    out[i] = in[i] ^ pattern[i];
+  }
+}
+
+/* XOR the length bytes at in with key, repeating key as many times as
+ * needed, and place the result in out.
+ * key is expanded once into a pattern that is a multiple of both key_length
+ * and XOR_VECTOR_BYTES, then the data is XORed against the pattern in whole
+ * strides. This avoids a division for every byte.
+ * out may be the same as in, but must not partially overlap it.
+ * key_length must not be zero. */
+void
+xor_repeat_bytes(uint8_t *out, const uint8_t *in, size_t length,
+                 const uint8_t *key, size_t key_length)
+{
+  assert(key != NULL);
+  assert(key_length > 0);
+
+  if (length == 0) {
+    return;
+  }
+
+  assert(out != NULL);
+  assert(in != NULL);
+
+  /* The key covers all the data, so there's nothing to repeat */
+  if (key_length >= length) {
+    xor_block(out, in, key, length);
+    return;
+  }
+
+  const uint8_t *pattern = key;
+  size_t pattern_length = key_length;
+  uint8_t expanded_pattern[XOR_PATTERN_MAX_BYTES];
+
+  /* Expand short keys into a pattern of whole vectors. Long keys are XORed
+   * in key-sized blocks, which are already long enough to vectorise. */
+  if (key_length <= XOR_PATTERN_MAX_BYTES / XOR_VECTOR_BYTES) {
+    pattern_length = lowest_common_multiple(key_length, XOR_VECTOR_BYTES);
+    assert(pattern_length <= sizeof(expanded_pattern));
+
+    for (size_t i = 0; i < pattern_length; i += key_length) {
+      memcpy(&expanded_pattern[i], key, key_length);
+    }
+
+    pattern = expanded_pattern;
+  }
+
+  assert(pattern_length % key_length == 0);
+
+  size_t i = 0;
+  for (i = 0; i + pattern_length <= length; i += pattern_length) {
+    xor_block(&out[i], &in[i], pattern, pattern_length);
+  }
+
+  /* The final partial pattern starts at a multiple of key_length, so the
+   * pattern is still aligned with the key */
+  xor_block(&out[i], &in[i], pattern, length - i);
+}
 
 /* XOR the bytearrays b1 and b2 into a newly allocated bytearray.
  * If b1 and b2 are different lengths, the shorter bytearray is XORed
@@ -55,20 +145,28 @@ bytearray_xor(const bytearray_t *b1, const bytearray_t *b2)
     /* don't repeat the assertions in bytearray_dup */
     return bytearray_dup(src);
   } else {
-    bytearray_t * const result = bytearray_alloc(MAX(bytearray_length(b1),
-                                                     bytearray_length(b2)));
+    /* XOR is commutative, so the shorter bytearray is the repeating key */
+    const bytearray_t *data = b1;
+    const bytearray_t *key = b2;
+    if (bytearray_length(b2) > bytearray_length(b1)) {
+      data = b2;
+      key = b1;
+    }
+
+    bytearray_t * const result = bytearray_alloc(bytearray_length(data));
     assert(result != NULL);
     assert(is_bytearray_consistent(result));
+    assert(bytearray_length(result) == MAX(bytearray_length(b1),
+                                           bytearray_length(b2)));
 
-    for (size_t i = 0; i < bytearray_length(result); i++) {
-      uint8_t byte1 = bytearray_get_checked(b1, i % bytearray_length(b1));
-      uint8_t byte2 = bytearray_get_checked(b2, i % bytearray_length(b2));
-
-      uint8_t byte_result = byte1 ^ byte2;
-      bytearray_set_checked(result, i, byte_result);
-
-      assert(is_bytearray_consistent(result));
-    }
+    xor_repeat_bytes(bytearray_pointer_checked(result, 0,
+                                               bytearray_length(result)),
+                     bytearray_const_pointer_checked(data, 0,
+                                                     bytearray_length(data)),
+                     bytearray_length(data),
+                     bytearray_const_pointer_checked(key, 0,
+                                                     bytearray_length(key)),
+                     bytearray_length(key));
 
     assert(is_bytearray_consistent(result));
     return result;
@@ -92,22 +190,191 @@ bytearray_xor_byte(const bytearray_t *bytearray, uint8_t byte)
   return result;
 }
 
-/* Count the number of bits set in b, and return it. */
-size_t
-bytearray_get_bit_count(const bytearray_t *b)
+/* Load a possibly unaligned uint64_t from bytes. */
+static inline uint64_t
+load_word(const uint8_t *bytes)
+{
+  uint64_t word = 0;
+  memcpy(&word, bytes, sizeof(word));
+  return word;
+}
+
+/* Count the number of bits that differ between the length bytes at bytes1
+ * and bytes2, starting at index start, and return it. If bytes2 is NULL,
+ * count the bits set in bytes1.
+ * Works a word at a time using the compiler's popcount builtin. It is always
+ * inlined, so the builtin is a single instruction in callers compiled for
+ * hardware popcount. */
+static CPU_INLINE size_t
+xor_bit_count_words(const uint8_t *bytes1, const uint8_t *bytes2,
+                    size_t length, size_t start)
 {
   size_t result = 0;
+  size_t i = start;
+
+  /* Use independent accumulators, so the popcounts can run in parallel */
+  size_t count0 = 0;
+  size_t count1 = 0;
+  for (; i + 2 * sizeof(uint64_t) <= length; i += 2 * sizeof(uint64_t)) {
+    uint64_t word0 = load_word(&bytes1[i]);
+    uint64_t word1 = load_word(&bytes1[i + sizeof(uint64_t)]);
+    if (bytes2 != NULL) {
+      word0 ^= load_word(&bytes2[i]);
+      word1 ^= load_word(&bytes2[i + sizeof(uint64_t)]);
+    }
+    count0 += (size_t)__builtin_popcountll(word0);
+    count1 += (size_t)__builtin_popcountll(word1);
+  }
+  result += count0 + count1;
 
-  for (size_t i = 0; i < bytearray_length(b); i++) {
-    uint8_t byte = bytearray_get_checked(b, i);
+  for (; i < length; i++) {
+    uint8_t byte = bytes1[i];
+    if (bytes2 != NULL) {
+      byte ^= bytes2[i];
+    }
     result += byte_get_bit_count(byte);
   }
 
-  /* The result is at most the number of bits in b */
-  assert(result <= bytearray_length(b) * BYTE_BIT);
   return result;
 }
 
+#if CPU_DISPATCH_X86
+
+/* Return the number of bits set in each 64-bit lane of v, using the nybble
+ * lookup table method (pshufb). */
+CPU_TARGET("avx2") static inline __m256i
+popcount_avx2(__m256i v)
+{
+  const __m256i nybble_counts = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3,
+                                                 1, 2, 2, 3, 2, 3, 3, 4,
+                                                 0, 1, 1, 2, 1, 2, 2, 3,
+                                                 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i low_mask = _mm256_set1_epi8(0x0f);
+
+  const __m256i low = _mm256_and_si256(v, low_mask);
+  const __m256i high = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+  const __m256i byte_counts = _mm256_add_epi8(
+                                    _mm256_shuffle_epi8(nybble_counts, low),
+                                    _mm256_shuffle_epi8(nybble_counts, high));
+
+  /* Sum the byte counts into each 64-bit lane */
+  return _mm256_sad_epu8(byte_counts, _mm256_setzero_si256());
+}
+
+/* Return the sum of the 64-bit lanes in v. */
+CPU_TARGET("avx2") static inline size_t
+sum_lanes_avx2(__m256i v)
+{
+  uint64_t lanes[4];
+  _mm256_storeu_si256((__m256i *)lanes, v);
+  return (size_t)(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+}
+
+/* xor_bit_count_words(), using the AVX2 nybble lookup popcount on whole
+ * vectors, and hardware popcount on the rest. */
+CPU_TARGET("avx2,popcnt") static size_t
+xor_bit_count_avx2(const uint8_t *bytes1, const uint8_t *bytes2,
+                   size_t length)
+{
+  __m256i counts = _mm256_setzero_si256();
+  size_t i = 0;
+
+  for (; i + sizeof(__m256i) <= length; i += sizeof(__m256i)) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)&bytes1[i]);
+    if (bytes2 != NULL) {
+      v = _mm256_xor_si256(v,
+                           _mm256_loadu_si256((const __m256i *)&bytes2[i]));
+    }
+    counts = _mm256_add_epi64(counts, popcount_avx2(v));
+  }
+
+  return (sum_lanes_avx2(counts)
+          + xor_bit_count_words(bytes1, bytes2, length, i));
+}
+
+/* xor_bit_count_words(), using hardware popcount. */
+CPU_TARGET("popcnt") static size_t
+xor_bit_count_popcnt(const uint8_t *bytes1, const uint8_t *bytes2,
+                     size_t length)
+{
+  return xor_bit_count_words(bytes1, bytes2, length, 0);
+}
+
+#endif
+
+/* Count the number of bits that differ between the length bytes at bytes1
+ * and bytes2, and return it. If bytes2 is NULL, count the bits set in bytes1.
+ * Uses the AVX2 or hardware popcount kernel when the CPU has them. */
+static size_t
+xor_bit_count(const uint8_t *bytes1, const uint8_t *bytes2, size_t length)
+{
+  size_t result;
+
+#if CPU_DISPATCH_X86
+  if (CPU_SUPPORTS("avx2") && CPU_SUPPORTS("popcnt")) {
+    result = xor_bit_count_avx2(bytes1, bytes2, length);
+  } else if (CPU_SUPPORTS("popcnt")) {
+    result = xor_bit_count_popcnt(bytes1, bytes2, length);
+  } else {
+    result = xor_bit_count_words(bytes1, bytes2, length, 0);
+  }
+#else
+  result = xor_bit_count_words(bytes1, bytes2, length, 0);
+#endif
+
+  /* The result is at most the number of bits in the input */
+  assert(result <= length * BYTE_BIT);
+  return result;
+}
+
+/* Count the number of bits set in the length bytes at bytes, and return it.
+ */
+size_t
+bit_count_bytes(const uint8_t *bytes, size_t length)
+{
+  if (length == 0) {
+    return 0;
+  }
+
+  assert(bytes != NULL);
+  assert(length <= SIZE_T_MAX / BYTE_BIT);
+
+  return xor_bit_count(bytes, NULL, length);
+}
+
+/* Count the number of bits set in b, and return it. */
+size_t
+bytearray_get_bit_count(const bytearray_t *b)
+{
+  assert(b != NULL);
+  assert(is_bytearray_consistent(b));
+
+  if (bytearray_length(b) == 0) {
+    return 0;
+  }
+
+  return bit_count_bytes(bytearray_const_pointer_checked(b, 0,
+                                                         bytearray_length(b)),
+                         bytearray_length(b));
+}
+
+/* Return the hamming distance between the length bytes at bytes1 and
+ * bytes2.
+ * XORs and counts bits in a single pass, without allocating.
+ * The inputs must have at most size_t bits. */
+size_t
+hamming_bytes(const uint8_t *bytes1, const uint8_t *bytes2, size_t length)
+{
+  if (length == 0) {
+    return 0;
+  }
+
+  assert(bytes1 != NULL);
+  assert(bytes2 != NULL);
+  assert(length <= SIZE_T_MAX / BYTE_BIT);
+
+  return xor_bit_count(bytes1, bytes2, length);
+}
 
 /* Return the hamming distance between b1 and b2.
  * b1 and b2 must be the same length, and have at most size_t bits. */
@@ -118,11 +385,32 @@ bytearray_hamming(const bytearray_t *b1, const bytearray_t *b2)
   assert(b2 != NULL);
 
   assert(bytearray_length(b1) == bytearray_length(b2));
-  assert(bytearray_length(b1) <= SIZE_T_MAX / BYTE_BIT);
 
-  bytearray_t *nonmatching = bytearray_xor(b1, b2);
-  assert(nonmatching != NULL);
-  assert(is_bytearray_consistent(nonmatching));
+  if (bytearray_length(b1) == 0) {
+    return 0;
+  }
+
+  return bytearray_hamming_range(b1, 0, b2, 0, bytearray_length(b1));
+}
+
+/* Return the hamming distance between the length bytes starting at index1 in
+ * b1, and the length bytes starting at index2 in b2.
+ * The ranges may overlap, and b1 may be the same as b2. This makes it easy to
+ * compare blocks within a single bytearray without copying them.
+ * Both ranges must be within their bytearrays, and length must not be zero.
+ */
+size_t
+bytearray_hamming_range(const bytearray_t *b1, size_t index1,
+                        const bytearray_t *b2, size_t index2, size_t length)
+{
+  assert(b1 != NULL);
+  assert(b2 != NULL);
+  assert(is_bytearray_consistent(b1));
+  assert(is_bytearray_consistent(b2));
+
+  /* These check that the ranges are within the bytearrays */
+  const uint8_t *bytes1 = bytearray_const_pointer_checked(b1, index1, length);
+  const uint8_t *bytes2 = bytearray_const_pointer_checked(b2, index2, length);
 
-  return bytearray_get_bit_count(nonmatching);
+  return hamming_bytes(bytes1, bytes2, length);
 }
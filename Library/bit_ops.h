@@ -24,16 +24,38 @@
 
 #include <sys/types.h>
 
+/* Repeating-key XOR Constants */
+
+/* Repeating keys are expanded into a pattern that is a multiple of this many
+ * bytes, so the data can be XORed in whole vector strides. (This is the AVX2
+ * register width, which is also a multiple of the SSE2 and uint64_t widths.)
+ */
+#define XOR_VECTOR_BYTES 32
+
+/* The largest expanded key pattern we keep on the stack. Keys whose pattern
+ * would be longer than this are long enough to XOR in key-sized blocks. */
+#define XOR_PATTERN_MAX_BYTES 4096
+
 /* Forward Declarations */
 
 typedef struct bytearray_t bytearray_t;
 
 /* Function Declarations */
 
+void xor_repeat_bytes(uint8_t *out, const uint8_t *in, size_t length,
+                      const uint8_t *key, size_t key_length);
+
 bytearray_t *bytearray_xor(const bytearray_t *b1, const bytearray_t *b2);
 bytearray_t *bytearray_xor_byte(const bytearray_t *bytearray, uint8_t byte);
 
+size_t bit_count_bytes(const uint8_t *bytes, size_t length);
 size_t bytearray_get_bit_count(const bytearray_t *b);
+
+size_t hamming_bytes(const uint8_t *bytes1, const uint8_t *bytes2,
+                     size_t length);
 size_t bytearray_hamming(const bytearray_t *b1, const bytearray_t *b2);
+size_t bytearray_hamming_range(const bytearray_t *b1, size_t index1,
+                               const bytearray_t *b2, size_t index2,
+                               size_t length);
 
 #endif /* bit_ops_h */
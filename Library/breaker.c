@@ -0,0 +1,448 @@
+//
+//  breaker.c
+//  MatasanoCrypto
+//
+//  Created by Tim Wilson-Brown on 18/10/2026.
+//  Copyright © 2026 teor - gmail: teor2345
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "breaker.h"
+
+#include <assert.h>
+#include <float.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bit_ops.h"
+#include "bytearray.h"
+#include "char.h"
+#include "histogram.h"
+#include "parallel.h"
+#include "score.h"
+
+/* Private Data Types */
+
+/* The shared state for solving the columns of every candidate keysize.
+ * Keys are stored one after another in keys, so the key for keysize slot
+ * starts at keys[key_offsets[slot]]. */
+typedef struct breaker_job_t {
+  const uint8_t *bytes;
+  size_t length;
+  const keysize_score_t *keysizes;
+  size_t keysize_count;
+  const size_t *key_offsets;
+  /* The keysize slot of each column task */
+  const size_t *column_slots;
+  uint8_t *keys;
+  double *scores;
+} breaker_job_t;
+
+/* Set options to the defaults: the keysize_options_init() rankings, solving
+ * the best BREAKER_KEYSIZE_COUNT_DEFAULT keysizes from each ranking, and one
+ * thread per CPU. */
+void
+breaker_options_init(breaker_options_t *options)
+{
+  assert(options != NULL);
+
+  memset(options, 0, sizeof(*options));
+  keysize_options_init(&options->keysize_options);
+  options->keysize_count = BREAKER_KEYSIZE_COUNT_DEFAULT;
+  options->coincidence_keysize_count = BREAKER_KEYSIZE_COUNT_DEFAULT;
+  options->thread_count = PARALLEL_THREADS_AUTO;
+}
+
+/* Column Solving */
+
+/* Find the key byte for the column task at index in the breaker_job_t
+ * context. Column c of a keysize is every byte encrypted with key byte c.
+ * A parallel_task_func. */
+static void
+breaker_column_task(size_t index, size_t thread_index, void *context)
+{
+  (void)thread_index;
+
+  const breaker_job_t * const job = context;
+  assert(job != NULL);
+
+  const size_t slot = job->column_slots[index];
+  const size_t keysize = job->keysizes[slot].keysize;
+  const size_t column = index - job->key_offsets[slot];
+  assert(column < keysize);
+  assert(column < job->length);
+
+  /* Each column is single-byte XORed English characters, so it has the
+   * letter frequencies of English, but none of its words.
+   * Log-likelihood only uses byte frequencies, and always has a best key. */
+  byte_histogram_t histogram;
+  byte_histogram_clear(&histogram);
+  for (size_t i = column; i < job->length; i += keysize) {
+    histogram.counts[job->bytes[i]]++;
+    histogram.length++;
+  }
+
+  double scores[BYTE_VALUE_COUNT];
+  score_histogram_all_keys_model(&histogram,
+                                 SCORE_MODEL_ENGLISH_LOG_LIKELIHOOD, scores);
+
+  /* Ties go to the lowest key */
+  size_t best_key = 0;
+  for (size_t key = 1; key < BYTE_VALUE_COUNT; key++) {
+    if (scores[key] > scores[best_key]) {
+      best_key = key;
+    }
+  }
+
+  job->keys[index] = (uint8_t)best_key;
+}
+
+/* Verification */
+
+/* Score the whole ciphertext decrypted with the key for keysize slot index
+ * in the breaker_job_t context. The plaintext is counted as it is
+ * decrypted, so it is never stored.
+ * A parallel_task_func. */
+static void
+breaker_verify_task(size_t index, size_t thread_index, void *context)
+{
+  (void)thread_index;
+
+  const breaker_job_t * const job = context;
+  assert(job != NULL);
+  assert(index < job->keysize_count);
+
+  const size_t keysize = job->keysizes[index].keysize;
+  const uint8_t * const key = &job->keys[job->key_offsets[index]];
+
+  byte_histogram_t histogram;
+  byte_histogram_clear(&histogram);
+
+  size_t column = 0;
+  for (size_t i = 0; i < job->length; i++) {
+    histogram.counts[job->bytes[i] ^ key[column]]++;
+
+    column++;
+    if (column == keysize) {
+      column = 0;
+    }
+  }
+  histogram.length = job->length;
+
+  job->scores[index] = score_english_histogram(&histogram);
+}
+
+/* Return the shortest period of the keysize bytes at key: the shortest
+ * length that divides keysize, and that key repeats with. Solving a
+ * multiple of the real keysize finds the real key repeated, so this is the
+ * real keysize. */
+static size_t
+key_period(const uint8_t *key, size_t keysize)
+{
+  assert(key != NULL);
+  assert(keysize > 0);
+
+  for (size_t period = 1; period < keysize; period++) {
+    if (keysize % period != 0) {
+      continue;
+    }
+
+    bool repeats = true;
+    for (size_t i = period; i < keysize && repeats; i++) {
+      repeats = (key[i] == key[i - period]);
+    }
+
+    if (repeats) {
+      return period;
+    }
+  }
+
+  return keysize;
+}
+
+/* Is result the same key as other? */
+static bool
+is_breaker_result_same_key(const breaker_result_t *result,
+                           const breaker_result_t *other)
+{
+  assert(result != NULL);
+  assert(other != NULL);
+
+  if (result->keysize != other->keysize) {
+    return false;
+  }
+
+  return memcmp(bytearray_const_pointer_checked(result->key, 0,
+                                                result->keysize),
+                bytearray_const_pointer_checked(other->key, 0,
+                                                other->keysize),
+                result->keysize) == 0;
+}
+
+/* Order results by descending score, then ascending keysize, then key bytes.
+ * Multiples of the real keysize decrypt to the same plaintext, so the
+ * shortest one wins. Equal keys compare equal, so they are sorted next to
+ * each other, even if other keys have the same score and keysize. */
+static int
+breaker_result_compare(const void *a, const void *b)
+{
+  const breaker_result_t * const result_a = a;
+  const breaker_result_t * const result_b = b;
+
+  if (result_a->score > result_b->score) {
+    return -1;
+  } else if (result_a->score < result_b->score) {
+    return 1;
+  } else if (result_a->keysize < result_b->keysize) {
+    return -1;
+  } else if (result_a->keysize > result_b->keysize) {
+    return 1;
+  }
+
+  return memcmp(bytearray_const_pointer_checked(result_a->key, 0,
+                                                result_a->keysize),
+                bytearray_const_pointer_checked(result_b->key, 0,
+                                                result_b->keysize),
+                result_a->keysize);
+}
+
+/* Keysize Selection */
+
+/* Rank the keysizes in ciphertext using the hamming distance and the index
+ * of coincidence, and place the best of each ranking in keysizes_out,
+ * without duplicates. keysizes_out must have space for
+ * options->keysize_count + options->coincidence_keysize_count scores.
+ * The two rankings fail in different ways: hamming distances are noisy on
+ * short or non-English text, and the index of coincidence can prefer
+ * multiples of the real keysize. Solving both sets lets the plaintext
+ * scores decide.
+ * Returns the number of keysizes placed in keysizes_out. */
+static size_t
+breaker_select_keysizes(const bytearray_t *ciphertext,
+                        const breaker_options_t *options,
+                        keysize_score_t *keysizes_out)
+{
+  size_t count = keysize_rank_hamming(ciphertext, &options->keysize_options,
+                                      keysizes_out, options->keysize_count);
+
+  if (options->coincidence_keysize_count == 0) {
+    return count;
+  }
+
+  keysize_score_t *coincidence = calloc(options->coincidence_keysize_count,
+                                        sizeof(*coincidence));
+  assert(coincidence != NULL);
+  const size_t coincidence_count = keysize_rank_coincidence(
+                                      ciphertext, &options->keysize_options,
+                                      coincidence,
+                                      options->coincidence_keysize_count);
+
+  for (size_t i = 0; i < coincidence_count; i++) {
+    bool found = false;
+
+    for (size_t j = 0; j < count; j++) {
+      if (keysizes_out[j].keysize == coincidence[i].keysize) {
+        keysizes_out[j].coincidence = coincidence[i].coincidence;
+        found = true;
+        break;
+      }
+    }
+
+    if (!found) {
+      keysizes_out[count] = coincidence[i];
+      keysizes_out[count].distance = DBL_MAX;
+      count++;
+    }
+  }
+
+  free(coincidence);
+
+  return count;
+}
+
+/* Breaking */
+
+/* Break the repeating-key XOR encryption of ciphertext.
+ * Ranks the keysizes in options->keysize_options, and solves the best of
+ * them (see breaker_select_keysizes()). Every column of every candidate keysize
+ * is solved as a separate parallel task. Then each candidate key is
+ * verified by scoring the whole decrypted ciphertext, also in parallel.
+ * Writes up to results_out_count results to results_out, best first, and
+ * returns the number written. The caller must free the results using
+ * breaker_results_free().
+ * If options is NULL, uses the defaults from breaker_options_init(). */
+size_t
+breaker_break_repeating_xor(const bytearray_t *ciphertext,
+                            const breaker_options_t *options,
+                            breaker_result_t *results_out,
+                            size_t results_out_count)
+{
+  assert(ciphertext != NULL);
+  assert(is_bytearray_consistent(ciphertext));
+  assert(results_out != NULL || results_out_count == 0);
+
+  breaker_options_t default_options;
+  if (options == NULL) {
+    breaker_options_init(&default_options);
+    options = &default_options;
+  }
+
+  /* Rank the likely keysizes */
+  keysize_score_t *keysizes = calloc(options->keysize_count
+                                     + options->coincidence_keysize_count
+                                     + 1,
+                                     sizeof(*keysizes));
+  assert(keysizes != NULL);
+  const size_t keysize_count = breaker_select_keysizes(ciphertext, options,
+                                                       keysizes);
+
+  /* Solve the columns of every keysize together, so that short keysizes
+   * don't leave threads idle */
+  size_t * const key_offsets = calloc(keysize_count + 1,
+                                      sizeof(*key_offsets));
+  assert(key_offsets != NULL);
+  for (size_t slot = 0; slot < keysize_count; slot++) {
+    key_offsets[slot + 1] = key_offsets[slot] + keysizes[slot].keysize;
+  }
+
+  const size_t column_count = key_offsets[keysize_count];
+  size_t * const column_slots = calloc(column_count + 1,
+                                       sizeof(*column_slots));
+  uint8_t * const keys = calloc(column_count + 1, sizeof(*keys));
+  double * const scores = calloc(keysize_count + 1, sizeof(*scores));
+  assert(column_slots != NULL);
+  assert(keys != NULL);
+  assert(scores != NULL);
+
+  for (size_t slot = 0; slot < keysize_count; slot++) {
+    for (size_t i = key_offsets[slot]; i < key_offsets[slot + 1]; i++) {
+      column_slots[i] = slot;
+    }
+  }
+
+  const size_t length = bytearray_length(ciphertext);
+
+  breaker_job_t job;
+  job.bytes = (length > 0
+               ? bytearray_const_pointer_checked(ciphertext, 0, length)
+               : NULL);
+  job.length = length;
+  job.keysizes = keysizes;
+  job.keysize_count = keysize_count;
+  job.key_offsets = key_offsets;
+  job.column_slots = column_slots;
+  job.keys = keys;
+  job.scores = scores;
+
+  parallel_for(column_count, options->thread_count, &breaker_column_task,
+               &job);
+  parallel_for(keysize_count, options->thread_count, &breaker_verify_task,
+               &job);
+
+  /* Rank the solved keysizes by their plaintext scores */
+  breaker_result_t * const ranking = calloc(keysize_count + 1,
+                                            sizeof(*ranking));
+  assert(ranking != NULL);
+
+  for (size_t slot = 0; slot < keysize_count; slot++) {
+    const uint8_t * const key = &keys[key_offsets[slot]];
+    const size_t period = key_period(key, keysizes[slot].keysize);
+
+    ranking[slot].keysize = period;
+    ranking[slot].distance = keysizes[slot].distance;
+    ranking[slot].coincidence = keysizes[slot].coincidence;
+    ranking[slot].key = bytes_to_bytearray(key, period);
+    ranking[slot].score = scores[slot];
+  }
+
+  if (keysize_count > 1) {
+    qsort(ranking, keysize_count, sizeof(*ranking), &breaker_result_compare);
+  }
+
+  /* Keys that were found more than once decrypt to the same plaintext, so
+   * they have the same score, and the key byte order puts them next to each
+   * other */
+  size_t unique_count = 0;
+  for (size_t i = 0; i < keysize_count; i++) {
+    if (unique_count > 0
+        && is_breaker_result_same_key(&ranking[i],
+                                      &ranking[unique_count - 1])) {
+      breaker_results_free(&ranking[i], 1);
+      continue;
+    }
+
+    ranking[unique_count] = ranking[i];
+    unique_count++;
+  }
+
+  const size_t result = (unique_count < results_out_count
+                         ? unique_count
+                         : results_out_count);
+  if (result > 0) {
+    memcpy(results_out, ranking, result * sizeof(*results_out));
+  }
+
+  /* Free the keys that weren't returned */
+  breaker_results_free(&ranking[result], unique_count - result);
+
+  free(ranking);
+  free(scores);
+  free(keys);
+  free(column_slots);
+  free(key_offsets);
+  free(keysizes);
+
+  return result;
+}
+
+/* Results */
+
+/* Decrypt ciphertext using result's key, and return the plaintext.
+ * The caller must free the returned bytearray using bytearray_free(). */
+bytearray_t *
+breaker_result_plaintext(const bytearray_t *ciphertext,
+                         const breaker_result_t *result)
+{
+  assert(ciphertext != NULL);
+  assert(result != NULL);
+  assert(result->key != NULL);
+
+  const size_t length = bytearray_length(ciphertext);
+  bytearray_t *plaintext = bytearray_alloc(length);
+
+  if (length > 0) {
+    xor_repeat_bytes(bytearray_pointer_checked(plaintext, 0, length),
+                     bytearray_const_pointer_checked(ciphertext, 0, length),
+                     length,
+                     bytearray_const_pointer_checked(result->key, 0,
+                                                     result->keysize),
+                     result->keysize);
+  }
+
+  return plaintext;
+}
+
+/* Free the keys in the count results at results, which were returned by
+ * breaker_break_repeating_xor(). Doesn't free results itself. */
+void
+breaker_results_free(breaker_result_t *results, size_t count)
+{
+  assert(results != NULL || count == 0);
+
+  for (size_t i = 0; i < count; i++) {
+    bytearray_free(results[i].key);
+  }
+}
@@ -0,0 +1,84 @@
+//
+//  breaker.h
+//  MatasanoCrypto
+//
+//  Created by Tim Wilson-Brown on 18/10/2026.
+//  Copyright © 2026 teor - gmail: teor2345
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef breaker_h
+#define breaker_h
+
+#include <sys/types.h>
+
+#include "keysize.h"
+
+/* Forward Declarations */
+
+typedef struct bytearray_t bytearray_t;
+
+/* Breaker Constants */
+
+/* The number of keysizes from each ranking that are fully solved by
+ * default */
+#define BREAKER_KEYSIZE_COUNT_DEFAULT 5
+
+/* Data Types */
+
+/* A solved keysize: its key, and how English the whole plaintext is */
+typedef struct breaker_result_t {
+  size_t keysize;
+  /* The keysize ranking scores (see keysize_score_t). If the key repeated,
+   * these are the scores of the multiple of keysize that was solved.
+   * If that keysize was only in the index of coincidence ranking, distance
+   * is DBL_MAX. If it was only in the hamming ranking, coincidence is 0.0.
+   */
+  double distance;
+  double coincidence;
+  /* The recovered key, which is keysize bytes long */
+  bytearray_t *key;
+  /* The score of the whole decrypted ciphertext, see
+   * score_english_histogram(). Higher scores are better. */
+  double score;
+} breaker_result_t;
+
+/* The options for breaker_break_repeating_xor(). Use breaker_options_init()
+ * to set the defaults. */
+typedef struct breaker_options_t {
+  /* The keysizes that are ranked */
+  keysize_options_t keysize_options;
+  /* The number of best hamming ranked keysizes that are solved */
+  size_t keysize_count;
+  /* The number of best index of coincidence ranked keysizes that are also
+   * solved. 0 only uses the hamming ranking. */
+  size_t coincidence_keysize_count;
+  /* See parallel_thread_count() */
+  size_t thread_count;
+} breaker_options_t;
+
+/* Function Declarations */
+
+void breaker_options_init(breaker_options_t *options);
+
+size_t breaker_break_repeating_xor(const bytearray_t *ciphertext,
+                                   const breaker_options_t *options,
+                                   breaker_result_t *results_out,
+                                   size_t results_out_count);
+bytearray_t *breaker_result_plaintext(const bytearray_t *ciphertext,
+                                      const breaker_result_t *result);
+void breaker_results_free(breaker_result_t *results, size_t count);
+
+#endif /* breaker_h */
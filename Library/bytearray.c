@@ -238,3 +238,38 @@ bytearray_pointer_checked(bytearray_t *bytearray, size_t index, size_t range)
 
   return &bytearray->bytes[index];
 }
+
+/* Like bytearray_pointer_checked, but for read-only access to a const
+ * bytearray. */
+const uint8_t *
+bytearray_const_pointer_checked(const bytearray_t *bytearray, size_t index,
+                                size_t range)
+{
+  assert(bytearray);
+  assert(is_bytearray_consistent(bytearray));
+  assert(index < bytearray_length(bytearray));
+  assert(range > 0);
+  size_t sum = 0;
+  assert(checked_add(index, range, &sum) == 0);
+  assert(sum <= bytearray_length(bytearray));
+
+  return &bytearray->bytes[index];
+}
+
+/* Return a view of every byte in bytearray.
+ * The view is valid until bytearray is modified or freed.
+ * If bytearray has zero length, the view's bytes are NULL. */
+byte_view_t
+bytearray_view(const bytearray_t *bytearray)
+{
+  assert(bytearray);
+  assert(is_bytearray_consistent(bytearray));
+
+  byte_view_t view;
+  view.length = bytearray_length(bytearray);
+  view.bytes = (view.length > 0
+                ? bytearray_const_pointer_checked(bytearray, 0, view.length)
+                : NULL);
+
+  return view;
+}
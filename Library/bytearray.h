@@ -29,6 +29,15 @@
 
 typedef struct bytearray_t bytearray_t;
 
+/* Data Types */
+
+/* A read-only view of length bytes, which may be part of a larger buffer.
+ * Views don't own their bytes. */
+typedef struct byte_view_t {
+  const uint8_t *bytes;
+  size_t length;
+} byte_view_t;
+
 /* Function Declarations */
 
 bool is_bytearray_consistent(const bytearray_t *bytearray);
@@ -53,5 +62,9 @@ void bytearray_set_checked(bytearray_t *bytearray, size_t index, uint8_t byte);
 uint8_t bytearray_get_checked(const bytearray_t *bytearray, size_t index);
 uint8_t *bytearray_pointer_checked(bytearray_t *bytearray, size_t index,
                                    size_t range);
+const uint8_t *bytearray_const_pointer_checked(const bytearray_t *bytearray,
+                                               size_t index, size_t range);
+
+byte_view_t bytearray_view(const bytearray_t *bytearray);
 
 #endif /* bytearray_h */
@@ -0,0 +1,388 @@
+//
+//  cache.c
+//  MatasanoCrypto
+//
+//  Created by Tim Wilson-Brown on 18/10/2026.
+//  Copyright © 2026 teor - gmail: teor2345
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "cache.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "topk.h"
+
+/* Private Constants */
+
+/* Marks the end of a bucket chain or the LRU list */
+#define SCORE_CACHE_NO_ENTRY SIZE_T_MAX
+
+/* 64-bit FNV-1a parameters
+ * http://www.isthe.com/chongo/tech/comp/fnv/ */
+#define FNV1A_64_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define FNV1A_64_PRIME        0x100000001b3ULL
+
+/* Private Data Types */
+
+/* A cached input, and the best key scores for it */
+typedef struct score_cache_entry_t {
+  uint64_t hash;
+  score_model_id_t model;
+  /* A copy of the input, so hash collisions are never hits */
+  uint8_t *bytes;
+  size_t length;
+  size_t result_count;
+  /* max_results slots in the cache's results array */
+  key_score_t *results;
+  /* The next entry in the same hash bucket */
+  size_t bucket_next;
+  /* The neighbouring entries in least recently used order */
+  size_t lru_prev;
+  size_t lru_next;
+} score_cache_entry_t;
+
+/* A bounded least recently used cache of scoring results.
+ * Entries are looked up using a chained hash table, and evicted from the
+ * tail of a doubly linked LRU list. Links are entry indexes. */
+struct score_cache_t {
+  size_t capacity;
+  size_t count;
+  score_cache_entry_t *entries;
+  /* The most key scores kept for each input */
+  size_t max_results;
+  key_score_t *results;
+  /* bucket_count is a power of two */
+  size_t bucket_count;
+  size_t *buckets;
+  /* The most and least recently used entries */
+  size_t lru_head;
+  size_t lru_tail;
+  size_t hits;
+  size_t misses;
+};
+
+/* Hashing */
+
+/* Return the 64-bit FNV-1a hash of the length bytes at bytes.
+ * This is a fast non-cryptographic hash: don't use it for untrusted inputs
+ * when collisions matter. */
+uint64_t
+score_cache_hash(const uint8_t *bytes, size_t length)
+{
+  assert(bytes != NULL || length == 0);
+
+  uint64_t hash = FNV1A_64_OFFSET_BASIS;
+  for (size_t i = 0; i < length; i++) {
+    hash ^= bytes[i];
+    hash *= FNV1A_64_PRIME;
+  }
+
+  return hash;
+}
+
+/* Return the hash of bytes and model, which is the cache key. */
+static uint64_t
+score_cache_key_hash(const uint8_t *bytes, size_t length,
+                     score_model_id_t model)
+{
+  uint64_t hash = score_cache_hash(bytes, length);
+  hash ^= (uint64_t)model;
+  hash *= FNV1A_64_PRIME;
+  return hash;
+}
+
+/* Allocation */
+
+/* Allocate and return a new, empty cache, which keeps the best max_results
+ * results for each of the capacity most recently used inputs.
+ * The caller must free the cache using score_cache_free(). */
+score_cache_t *
+score_cache_alloc(size_t capacity, size_t max_results)
+{
+  assert(capacity > 0);
+  assert(capacity < SIZE_T_MAX/2);
+  assert(max_results > 0);
+  assert(max_results < SIZE_T_MAX/capacity);
+
+  score_cache_t *cache = malloc(sizeof(*cache));
+  assert(cache != NULL);
+
+  cache->capacity = capacity;
+  cache->count = 0;
+  cache->entries = calloc(capacity, sizeof(*cache->entries));
+  assert(cache->entries != NULL);
+
+  cache->max_results = max_results;
+  cache->results = calloc(capacity * max_results, sizeof(*cache->results));
+  assert(cache->results != NULL);
+  for (size_t i = 0; i < capacity; i++) {
+    cache->entries[i].results = &cache->results[i * max_results];
+  }
+
+  /* Keep the load factor at or below 1/2 */
+  cache->bucket_count = 1;
+  while (cache->bucket_count < capacity * 2) {
+    cache->bucket_count *= 2;
+  }
+  cache->buckets = malloc(cache->bucket_count * sizeof(*cache->buckets));
+  assert(cache->buckets != NULL);
+  for (size_t i = 0; i < cache->bucket_count; i++) {
+    cache->buckets[i] = SCORE_CACHE_NO_ENTRY;
+  }
+
+  cache->lru_head = SCORE_CACHE_NO_ENTRY;
+  cache->lru_tail = SCORE_CACHE_NO_ENTRY;
+  cache->hits = 0;
+  cache->misses = 0;
+
+  return cache;
+}
+
+/* Free cache, which was allocated by score_cache_alloc().
+ * Use the score_cache_free() macro, which also sets cache to NULL. */
+void
+score_cache_free_(score_cache_t *cache)
+{
+  if (cache == NULL) {
+    return;
+  }
+
+  for (size_t i = 0; i < cache->count; i++) {
+    free(cache->entries[i].bytes);
+  }
+
+  free(cache->buckets);
+  free(cache->results);
+  free(cache->entries);
+  free(cache);
+}
+
+/* Lists */
+
+/* Return the bucket for hash in cache. */
+static size_t *
+score_cache_bucket(score_cache_t *cache, uint64_t hash)
+{
+  return &cache->buckets[(size_t)hash & (cache->bucket_count - 1)];
+}
+
+/* Remove the entry at index from the LRU list in cache. */
+static void
+score_cache_lru_unlink(score_cache_t *cache, size_t index)
+{
+  score_cache_entry_t * const entry = &cache->entries[index];
+
+  if (entry->lru_prev == SCORE_CACHE_NO_ENTRY) {
+    cache->lru_head = entry->lru_next;
+  } else {
+    cache->entries[entry->lru_prev].lru_next = entry->lru_next;
+  }
+
+  if (entry->lru_next == SCORE_CACHE_NO_ENTRY) {
+    cache->lru_tail = entry->lru_prev;
+  } else {
+    cache->entries[entry->lru_next].lru_prev = entry->lru_prev;
+  }
+}
+
+/* Put the entry at index at the head of the LRU list in cache. */
+static void
+score_cache_lru_push_head(score_cache_t *cache, size_t index)
+{
+  score_cache_entry_t * const entry = &cache->entries[index];
+
+  entry->lru_prev = SCORE_CACHE_NO_ENTRY;
+  entry->lru_next = cache->lru_head;
+
+  if (cache->lru_head == SCORE_CACHE_NO_ENTRY) {
+    cache->lru_tail = index;
+  } else {
+    cache->entries[cache->lru_head].lru_prev = index;
+  }
+
+  cache->lru_head = index;
+}
+
+/* Remove the entry at index from its hash bucket in cache. */
+static void
+score_cache_bucket_unlink(score_cache_t *cache, size_t index)
+{
+  size_t *link = score_cache_bucket(cache, cache->entries[index].hash);
+
+  while (*link != index) {
+    assert(*link != SCORE_CACHE_NO_ENTRY);
+    link = &cache->entries[*link].bucket_next;
+  }
+
+  *link = cache->entries[index].bucket_next;
+}
+
+/* Return the index of the entry for bytes and model in cache, or
+ * SCORE_CACHE_NO_ENTRY if there isn't one. */
+static size_t
+score_cache_find(score_cache_t *cache, uint64_t hash, const uint8_t *bytes,
+                 size_t length, score_model_id_t model)
+{
+  size_t index = *score_cache_bucket(cache, hash);
+
+  while (index != SCORE_CACHE_NO_ENTRY) {
+    const score_cache_entry_t * const entry = &cache->entries[index];
+
+    if (entry->hash == hash && entry->model == model
+        && entry->length == length
+        && (length == 0 || memcmp(entry->bytes, bytes, length) == 0)) {
+      return index;
+    }
+
+    index = entry->bucket_next;
+  }
+
+  return SCORE_CACHE_NO_ENTRY;
+}
+
+/* Lookup and Insert */
+
+/* If cache has results for the length bytes at bytes scored with model,
+ * copy them to results_out, put their count in result_count_out, and
+ * return true. results_out must have room for score_cache_max_results()
+ * results. Results are in descending score order.
+ * Otherwise, return false.
+ * Updates the hit and miss counters. */
+bool
+score_cache_lookup(score_cache_t *cache, const uint8_t *bytes, size_t length,
+                   score_model_id_t model,
+                   key_score_t *results_out, size_t *result_count_out)
+{
+  assert(cache != NULL);
+  assert(bytes != NULL || length == 0);
+  assert(results_out != NULL);
+  assert(result_count_out != NULL);
+
+  const uint64_t hash = score_cache_key_hash(bytes, length, model);
+  const size_t index = score_cache_find(cache, hash, bytes, length, model);
+
+  if (index == SCORE_CACHE_NO_ENTRY) {
+    cache->misses++;
+    return false;
+  }
+
+  const score_cache_entry_t * const entry = &cache->entries[index];
+  memcpy(results_out, entry->results,
+         entry->result_count * sizeof(*results_out));
+  *result_count_out = entry->result_count;
+
+  score_cache_lru_unlink(cache, index);
+  score_cache_lru_push_head(cache, index);
+
+  cache->hits++;
+  return true;
+}
+
+/* Store the result_count results for the length bytes at bytes scored with
+ * model in cache. Only the best score_cache_max_results() results are kept.
+ * If the cache is full, evicts the least recently used entry. If there is
+ * already an entry for bytes and model, replaces its results. */
+void
+score_cache_insert(score_cache_t *cache, const uint8_t *bytes, size_t length,
+                   score_model_id_t model, const key_score_t *results,
+                   size_t result_count)
+{
+  assert(cache != NULL);
+  assert(bytes != NULL || length == 0);
+  assert(results != NULL || result_count == 0);
+
+  const uint64_t hash = score_cache_key_hash(bytes, length, model);
+  size_t index = score_cache_find(cache, hash, bytes, length, model);
+
+  if (index != SCORE_CACHE_NO_ENTRY) {
+    score_cache_lru_unlink(cache, index);
+  } else {
+    if (cache->count < cache->capacity) {
+      index = cache->count;
+      cache->count++;
+    } else {
+      /* Evict the least recently used entry */
+      index = cache->lru_tail;
+      assert(index != SCORE_CACHE_NO_ENTRY);
+      score_cache_lru_unlink(cache, index);
+      score_cache_bucket_unlink(cache, index);
+      free(cache->entries[index].bytes);
+    }
+
+    score_cache_entry_t * const entry = &cache->entries[index];
+    entry->hash = hash;
+    entry->model = model;
+    entry->length = length;
+    entry->bytes = malloc(length > 0 ? length : 1);
+    assert(entry->bytes != NULL);
+    if (length > 0) {
+      memcpy(entry->bytes, bytes, length);
+    }
+
+    size_t * const bucket = score_cache_bucket(cache, hash);
+    entry->bucket_next = *bucket;
+    *bucket = index;
+  }
+
+  /* Keep the best results, in descending order */
+  score_cache_entry_t * const entry = &cache->entries[index];
+  entry->result_count = 0;
+
+  for (size_t i = 0; i < result_count; i++) {
+    entry->result_count = topk_insert_sorted(entry->results,
+                                             entry->result_count,
+                                             cache->max_results,
+                                             sizeof(*entry->results),
+                                             &results[i],
+                                             &is_key_score_better);
+  }
+
+  score_cache_lru_push_head(cache, index);
+
+  assert(cache->count <= cache->capacity);
+  assert(entry->result_count <= cache->max_results);
+}
+
+/* Accessors */
+
+/* Return the most results cache keeps for each input. */
+size_t
+score_cache_max_results(const score_cache_t *cache)
+{
+  assert(cache != NULL);
+
+  return cache->max_results;
+}
+
+/* Return the number of lookups in cache that found results. */
+size_t
+score_cache_hits(const score_cache_t *cache)
+{
+  assert(cache != NULL);
+
+  return cache->hits;
+}
+
+/* Return the number of lookups in cache that didn't find results. */
+size_t
+score_cache_misses(const score_cache_t *cache)
+{
+  assert(cache != NULL);
+
+  return cache->misses;
+}
@@ -0,0 +1,59 @@
+//
+//  cache.h
+//  MatasanoCrypto
+//
+//  Created by Tim Wilson-Brown on 18/10/2026.
+//  Copyright © 2026 teor - gmail: teor2345
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef cache_h
+#define cache_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "score.h"
+
+/* Forward Declarations */
+
+typedef struct score_cache_t score_cache_t;
+
+/* Function Declarations */
+
+uint64_t score_cache_hash(const uint8_t *bytes, size_t length);
+
+score_cache_t *score_cache_alloc(size_t capacity, size_t max_results);
+void score_cache_free_(score_cache_t *cache);
+#define score_cache_free(cache) \
+  do { \
+    score_cache_free_(cache); \
+    cache = NULL; \
+  } while (0)
+
+bool score_cache_lookup(score_cache_t *cache, const uint8_t *bytes,
+                        size_t length, score_model_id_t model,
+                        key_score_t *results_out,
+                        size_t *result_count_out);
+void score_cache_insert(score_cache_t *cache, const uint8_t *bytes,
+                        size_t length, score_model_id_t model,
+                        const key_score_t *results, size_t result_count);
+
+size_t score_cache_max_results(const score_cache_t *cache);
+size_t score_cache_hits(const score_cache_t *cache);
+size_t score_cache_misses(const score_cache_t *cache);
+
+#endif /* cache_h */
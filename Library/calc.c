@@ -22,6 +22,7 @@
 #include "calc.h"
 
 #include <assert.h>
+#include <stdint.h>
 
 /* Return the ceiling (rounded up) value of dividend / divisor. */
 size_t
@@ -36,3 +37,41 @@ ceil_div(size_t dividend, size_t divisor)
 
   return result;
 }
+
+/* Return the greatest common divisor of a and b.
+ * a and b must not both be zero. */
+size_t
+greatest_common_divisor(size_t a, size_t b)
+{
+  assert(a != 0 || b != 0);
+
+  /* Euclid's algorithm */
+  while (b != 0) {
+    const size_t remainder = a % b;
+    a = b;
+    b = remainder;
+  }
+
+  assert(a != 0);
+  return a;
+}
+
+/* Return the lowest common multiple of a and b.
+ * a and b must be non-zero, and their lowest common multiple must fit in a
+ * size_t. */
+size_t
+lowest_common_multiple(size_t a, size_t b)
+{
+  assert(a != 0);
+  assert(b != 0);
+
+  /* Divide first to avoid overflowing the intermediate product */
+  const size_t a_reduced = a / greatest_common_divisor(a, b);
+  assert(a_reduced <= SIZE_MAX / b);
+  const size_t result = a_reduced * b;
+
+  assert(result % a == 0);
+  assert(result % b == 0);
+
+  return result;
+}
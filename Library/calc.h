@@ -27,5 +27,7 @@
 /* Function Declarations */
 
 size_t ceil_div(size_t dividend, size_t divisor);
+size_t greatest_common_divisor(size_t a, size_t b);
+size_t lowest_common_multiple(size_t a, size_t b);
 
 #endif /* calc_h */
@@ -0,0 +1,136 @@
+//
+//  candidate.c
+//  MatasanoCrypto
+//
+//  Created by Tim Wilson-Brown on 18/10/2026.
+//  Copyright © 2026 teor - gmail: teor2345
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "candidate.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bit_ops.h"
+#include "bytearray.h"
+#include "hex.h"
+#include "score.h"
+#include "topk.h"
+
+/* Construction */
+
+/* Return a candidate for the key and score in entry, which decrypts
+ * ciphertext. The caller must pass the ciphertext for entry's line. */
+candidate_t
+candidate_from_topk_entry(const topk_entry_t *entry,
+                          const bytearray_t *ciphertext)
+{
+  assert(entry != NULL);
+  assert(ciphertext != NULL);
+
+  candidate_t candidate;
+  candidate.ciphertext = ciphertext;
+  candidate.key = entry->key;
+  candidate.score = entry->score;
+
+  return candidate;
+}
+
+/* Materialization */
+
+/* Decrypt candidate's ciphertext into bytes_out, which has space for
+ * bytes_capacity bytes. bytes_capacity must be at least the ciphertext
+ * length. Doesn't allocate any memory. */
+void
+candidate_plaintext_bytes(const candidate_t *candidate, uint8_t *bytes_out,
+                          size_t bytes_capacity)
+{
+  assert(candidate != NULL);
+  assert(candidate->ciphertext != NULL);
+
+  const byte_view_t ciphertext = bytearray_view(candidate->ciphertext);
+  assert(ciphertext.length <= bytes_capacity);
+  assert(bytes_out != NULL || ciphertext.length == 0);
+
+  for (size_t i = 0; i < ciphertext.length; i++) {
+    bytes_out[i] = ciphertext.bytes[i] ^ candidate->key;
+  }
+}
+
+/* Decrypt candidate's ciphertext, and return the plaintext.
+ * The caller must free the returned bytearray using bytearray_free(). */
+bytearray_t *
+candidate_plaintext(const candidate_t *candidate)
+{
+  assert(candidate != NULL);
+  assert(candidate->ciphertext != NULL);
+
+  return bytearray_xor_byte(candidate->ciphertext, candidate->key);
+}
+
+/* Rendering */
+
+/* Return candidate's plaintext as a hex string.
+ * The caller must free the returned string. */
+char *
+candidate_to_hexstr(const candidate_t *candidate)
+{
+  bytearray_t *plaintext = candidate_plaintext(candidate);
+  char *hexstr = bytearray_to_hexstr(plaintext);
+  bytearray_free(plaintext);
+
+  return hexstr;
+}
+
+/* Return candidate's plaintext as an escaped string.
+ * The caller must free the returned string. */
+char *
+candidate_to_escstr(const candidate_t *candidate)
+{
+  bytearray_t *plaintext = candidate_plaintext(candidate);
+  char *escstr = bytearray_to_escstr(plaintext);
+  bytearray_free(plaintext);
+
+  return escstr;
+}
+
+/* Print candidate's key, score, and plaintext renderings. */
+void
+candidate_print(const candidate_t *candidate)
+{
+  assert(candidate != NULL);
+
+  const uint8_t byte = candidate->key;
+
+  /* Bytes -> Hex */
+  printf("XOR Byte:              %hhu %c 0x%hhx\n", byte, byte, byte);
+  printf("Overall Score:         %.3f\n", candidate->score);
+
+  /* Only decrypt the candidates we print */
+  bytearray_t *output_bytearray = candidate_plaintext(candidate);
+
+  char *output_hexstr = bytearray_to_hexstr(output_bytearray);
+  printf("Hex XOR:               %s\n", output_hexstr);
+
+  char *output_escstr = bytearray_to_escstr(output_bytearray);
+  printf("Escaped Bytes XOR:     %s\n", output_escstr);
+  printf("\n");
+
+  free(output_hexstr);
+  free(output_escstr);
+  bytearray_free(output_bytearray);
+}
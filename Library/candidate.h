@@ -0,0 +1,58 @@
+//
+//  candidate.h
+//  MatasanoCrypto
+//
+//  Created by Tim Wilson-Brown on 18/10/2026.
+//  Copyright © 2026 teor - gmail: teor2345
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef candidate_h
+#define candidate_h
+
+#include <stdint.h>
+#include <sys/types.h>
+
+/* Forward Declarations */
+
+typedef struct bytearray_t bytearray_t;
+typedef struct topk_entry_t topk_entry_t;
+
+/* Data Types */
+
+/* A candidate single-byte XOR decryption.
+ * Candidates refer to their ciphertext, rather than holding a copy of their
+ * plaintext. So they take constant space, regardless of the length of the
+ * text. The plaintext and its renderings are only produced on demand. */
+typedef struct candidate_t {
+  /* The candidate doesn't own the ciphertext, which must outlive it */
+  const bytearray_t *ciphertext;
+  uint8_t key;
+  double score;
+} candidate_t;
+
+/* Function Declarations */
+
+candidate_t candidate_from_topk_entry(const topk_entry_t *entry,
+                                      const bytearray_t *ciphertext);
+
+void candidate_plaintext_bytes(const candidate_t *candidate,
+                               uint8_t *bytes_out, size_t bytes_capacity);
+bytearray_t *candidate_plaintext(const candidate_t *candidate);
+char *candidate_to_hexstr(const candidate_t *candidate);
+char *candidate_to_escstr(const candidate_t *candidate);
+void candidate_print(const candidate_t *candidate);
+
+#endif /* candidate_h */
@@ -70,18 +70,12 @@ value_to_char(uint8_t value, uint8_t min, uint8_t max, char basis,
   return false;
 }
 
-/* Count the number of bits set in byte, and return it. */
+/* Count the number of bits set in byte, and return it.
+ * Uses the hardware popcount instruction, if available. */
 uint8_t
 byte_get_bit_count(uint8_t byte)
 {
-  uint8_t result = 0;
-
-  for (uint8_t i = 0; i < BYTE_BIT; i++) {
-    uint8_t mask = (uint8_t)(1 << i);
-    if (byte & mask) {
-      result++;
-    }
-  }
+  const uint8_t result = (uint8_t)__builtin_popcount(byte);
 
   assert(result <= BYTE_BIT);
   return result;
@@ -24,6 +24,7 @@
 
 #include <limits.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <sys/types.h>
 
 /* Function Declarations */
@@ -31,6 +32,22 @@
 static const uint8_t BYTE_BIT = CHAR_BIT;
 static const uint8_t ASCII_CHARS_PER_BYTE = 1;
 
+/* The number of distinct byte values. This is a macro so it can be used as
+ * an array size. */
+#define BYTE_VALUE_COUNT (UINT8_MAX + 1)
+
+/* Expand to the comma-separated values of f(b) for every byte value b.
+ * Used to build lookup tables at compile time. */
+#define BYTE_TABLE_4(f, b)   f(b), f((b) + 1), f((b) + 2), f((b) + 3)
+#define BYTE_TABLE_16(f, b)  BYTE_TABLE_4(f, b), BYTE_TABLE_4(f, (b) + 4), \
+                             BYTE_TABLE_4(f, (b) + 8), \
+                             BYTE_TABLE_4(f, (b) + 12)
+#define BYTE_TABLE_64(f, b)  BYTE_TABLE_16(f, b), BYTE_TABLE_16(f, (b) + 16), \
+                             BYTE_TABLE_16(f, (b) + 32), \
+                             BYTE_TABLE_16(f, (b) + 48)
+#define BYTE_TABLE(f)        BYTE_TABLE_64(f, 0), BYTE_TABLE_64(f, 64), \
+                             BYTE_TABLE_64(f, 128), BYTE_TABLE_64(f, 192)
+
 bool char_to_value(char c, char min, char max, uint8_t basis,
                    uint8_t *value_out);
 bool value_to_char(uint8_t value, uint8_t min, uint8_t max, char basis,
@@ -0,0 +1,46 @@
+//
+//  cpu.h
+//  MatasanoCrypto
+//
+//  Created by Tim Wilson-Brown on 18/10/2026.
+//  Copyright © 2026 teor - gmail: teor2345
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef cpu_h
+#define cpu_h
+
+/* Run-Time CPU Dispatch */
+
+/* The targets are built for the baseline instruction set of their
+ * architecture, so they run on any CPU. On x86, kernels that use newer
+ * instructions are compiled for them with CPU_TARGET(), and only called when
+ * CPU_SUPPORTS() finds them on the CPU running the program. */
+#if defined(__x86_64__) || defined(__i386__)
+#define CPU_DISPATCH_X86 1
+/* Compile a function for the comma-separated list of instruction sets in
+ * features, like "avx2,popcnt" */
+#define CPU_TARGET(features) __attribute__((target(features)))
+/* Is the instruction set feature available at run time? */
+#define CPU_SUPPORTS(feature) __builtin_cpu_supports(feature)
+#else
+#define CPU_DISPATCH_X86 0
+#endif
+
+/* Inline a function into every caller, even when optimisation is off, so it
+ * is compiled for each caller's CPU_TARGET() */
+#define CPU_INLINE inline __attribute__((always_inline))
+
+#endif /* cpu_h */
@@ -0,0 +1,718 @@
+//
+//  detect.c
+//  MatasanoCrypto
+//
+//  Created by Tim Wilson-Brown on 18/10/2026.
+//  Copyright © 2026 teor - gmail: teor2345
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "detect.h"
+
+#include <assert.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/param.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "batch.h"
+#include "cache.h"
+#include "calc.h"
+#include "hex.h"
+#include "histogram.h"
+#include "ingest.h"
+#include "keyset.h"
+#include "parallel.h"
+#include "score.h"
+#include "topk.h"
+#include "triage.h"
+
+/* Private Data Types */
+
+/* A line that might be XORed text, waiting to be searched */
+typedef struct searchable_line_t {
+  /* The line number within its chunk */
+  size_t line;
+  const char *hexstr;
+  size_t hexstr_len;
+  /* The decoded line is at bytes_offset in its thread's scratch bytes, if
+   * it is short enough to be searched in a line batch */
+  size_t bytes_offset;
+  size_t length;
+  /* The XOR values that decrypt every byte in the line to text */
+  keyset_t text_keys;
+  byte_histogram_t histogram;
+  triage_t triage;
+} searchable_line_t;
+
+/* A newline-aligned part of the input, and its results */
+typedef struct detect_chunk_t {
+  const char *text;
+  size_t length;
+  /* The number of lines in the chunk, including empty lines */
+  size_t line_count;
+  /* The number of lines in the previous chunks */
+  size_t first_line;
+  /* The best candidates in the chunk, numbered by line within the chunk */
+  topk_t *top_candidates;
+  /* The lines that had candidates kept by top_candidates, numbered and
+   * located within the chunk. Their candidates may have been replaced
+   * since. */
+  detect_line_t *located_lines;
+  size_t located_line_count;
+  size_t located_line_capacity;
+} detect_chunk_t;
+
+/* Each thread's reusable buffers. Only used by a single thread, so they
+ * don't need locking. */
+typedef struct detect_scratch_t {
+  /* The decoded short lines in the current chunk */
+  uint8_t *bytes;
+  size_t bytes_length;
+  size_t bytes_capacity;
+  searchable_line_t *searchable;
+  size_t searchable_capacity;
+  score_cache_t *line_cache;
+  /* A lane group of short lines, and their scores for every XOR value */
+  line_batch_t *line_batch;
+  double (*batch_scores)[BYTE_VALUE_COUNT];
+} detect_scratch_t;
+
+/* The state shared by every task in a detection */
+typedef struct detect_job_t {
+  detect_chunk_t *chunks;
+  detect_scratch_t *scratch;
+  double min_score;
+  size_t candidate_count;
+} detect_job_t;
+
+/* Line Search */
+
+/* qsort() comparator for searchable lines: the most promising lines come
+ * first, and ties are in line order. */
+static int
+compare_searchable_lines(const void *a, const void *b)
+{
+  const searchable_line_t *line_a = a;
+  const searchable_line_t *line_b = b;
+
+  if (line_a->triage.promise != line_b->triage.promise) {
+    return line_a->triage.promise > line_b->triage.promise ? -1 : 1;
+  } else if (line_a->line != line_b->line) {
+    return line_a->line < line_b->line ? -1 : 1;
+  } else {
+    return 0;
+  }
+}
+
+/* Remember where line is in chunk: the hexstr_len characters at hexstr.
+ * Call this once for each line that has candidates kept by chunk. */
+static void
+locate_line(detect_chunk_t *chunk, const char *hexstr, size_t hexstr_len,
+            size_t line)
+{
+  if (chunk->located_line_count == chunk->located_line_capacity) {
+    chunk->located_line_capacity = MAX(chunk->located_line_capacity * 2, 16);
+    chunk->located_lines = realloc(chunk->located_lines,
+                                   (chunk->located_line_capacity
+                                    * sizeof(*chunk->located_lines)));
+    assert(chunk->located_lines != NULL);
+  }
+
+  const size_t index = chunk->located_line_count;
+  chunk->located_lines[index].line = line;
+  chunk->located_lines[index].offset = (size_t)(hexstr - chunk->text);
+  chunk->located_lines[index].length = hexstr_len;
+  chunk->located_line_count++;
+}
+
+/* Offer the cached results for the hexstr_len characters at hexstr in cache
+ * to chunk's candidates as line.
+ * Returns false if there are no cached results. */
+static bool
+offer_cached_line(score_cache_t *cache, const char *hexstr,
+                  size_t hexstr_len, size_t line, detect_chunk_t *chunk)
+{
+  key_score_t line_results[BYTE_VALUE_COUNT];
+  assert(score_cache_max_results(cache) <= BYTE_VALUE_COUNT);
+  size_t line_result_count = 0;
+
+  if (!score_cache_lookup(cache, (const uint8_t *)hexstr, hexstr_len,
+                          SCORE_MODEL_ENGLISH_HEURISTIC, line_results,
+                          &line_result_count)) {
+    return false;
+  }
+
+  bool kept = false;
+  for (size_t i = 0; i < line_result_count; i++) {
+    kept = topk_offer(chunk->top_candidates, line, line_results[i].key,
+                      line_results[i].score) || kept;
+  }
+
+  if (kept) {
+    locate_line(chunk, hexstr, hexstr_len, line);
+  }
+
+  return true;
+}
+
+/* Offer the exact scores in scores for current's text keys to chunk's
+ * candidates, and remember them in cache. Scores below bound are upper
+ * bounds, so they aren't offered or cached. */
+static void
+offer_line_scores(const searchable_line_t *current,
+                  const double scores[BYTE_VALUE_COUNT], double bound,
+                  score_cache_t *cache, detect_chunk_t *chunk)
+{
+  /* Try every different XOR value
+   * use do ... while to get every single byte value in the loop */
+  key_score_t key_scores[BYTE_VALUE_COUNT];
+  size_t key_score_count = 0;
+  bool kept = false;
+  uint8_t byte = 0;
+  do {
+    /* Upper bounds can't beat the candidates we already have */
+    if (keyset_contains(&current->text_keys, byte) && scores[byte] >= bound) {
+      kept = topk_offer(chunk->top_candidates, current->line, byte,
+                        scores[byte]) || kept;
+      key_scores[key_score_count].key = byte;
+      key_scores[key_score_count].score = scores[byte];
+      key_score_count++;
+    }
+
+    byte++;
+
+    /* rely on unsigned integer wrapping to 0 on overflow to exit the loop */
+  } while (byte != 0);
+
+  if (kept) {
+    locate_line(chunk, current->hexstr, current->hexstr_len, current->line);
+  }
+
+  /* A line's cached results are its best exact scores, up to the candidate
+   * count. Keys that couldn't beat the candidates kept when it was first
+   * searched are left out. Those candidates are offered to the final
+   * results, so the skipped keys can't be in them. And no line can put more
+   * than the candidate count in the final results. So a cached copy of a
+   * line offers the same final candidates as a newly searched copy. */
+  score_cache_insert(cache, (const uint8_t *)current->hexstr,
+                     current->hexstr_len, SCORE_MODEL_ENGLISH_HEURISTIC,
+                     key_scores, key_score_count);
+}
+
+/* Score every XOR value for current using its histogram, and offer the best
+ * ones to chunk's candidates, like offer_line_scores().
+ * Only scores of at least min_score are offered. */
+static void
+search_line_histogram(const searchable_line_t *current, double min_score,
+                      score_cache_t *cache, detect_chunk_t *chunk)
+{
+  /* Stop scoring each XOR value as soon as it can't reach the minimum, or
+   * beat the candidates we already have */
+  const double bound = fmax(min_score,
+                            topk_min_score(chunk->top_candidates));
+  double scores[BYTE_VALUE_COUNT];
+  score_english_histogram_all_keys_bounded(&current->histogram, bound,
+                                           scores);
+
+  offer_line_scores(current, scores, bound, cache, chunk);
+}
+
+/* Score every line in scratch's line batch, a lane group at a time, and
+ * offer the best XOR values for each line to chunk's candidates, like
+ * offer_line_scores(). Each line's id is its searchable line index.
+ * Only scores of at least min_score are offered. */
+static void
+search_line_batch(detect_scratch_t *scratch, double min_score,
+                  detect_chunk_t *chunk)
+{
+  const line_batch_t * const batch = scratch->line_batch;
+  const size_t count = line_batch_count(batch);
+
+  /* Only score the XOR values that decrypt some line in the group to text */
+  keyset_t group_keys;
+  keyset_clear(&group_keys);
+  for (size_t i = 0; i < count; i++) {
+    keyset_union(&group_keys,
+                 &scratch->searchable[line_batch_id(batch, i)].text_keys);
+  }
+
+  /* The whole group shares one bound, so scores can stop early, but some
+   * lines might be exactly scored when they didn't need to be */
+  const double bound = fmax(min_score,
+                            topk_min_score(chunk->top_candidates));
+  double key_scores[LINE_BATCH_LANE_COUNT];
+
+  /* use do ... while to get every single byte value in the loop */
+  uint8_t key = 0;
+  do {
+    if (keyset_contains(&group_keys, key)) {
+      line_batch_score_key(batch, key, bound, key_scores);
+
+      for (size_t i = 0; i < count; i++) {
+        scratch->batch_scores[i][key] = key_scores[i];
+      }
+    }
+
+    key++;
+
+    /* rely on unsigned integer wrapping to 0 on overflow to exit the loop */
+  } while (key != 0);
+
+  /* Each line's text keys are in the group's keys, so every score that is
+   * offered has been set */
+  for (size_t i = 0; i < count; i++) {
+    offer_line_scores(&scratch->searchable[line_batch_id(batch, i)],
+                      scratch->batch_scores[i], bound, scratch->line_cache,
+                      chunk);
+  }
+}
+
+/* Search the searchable_count searchable lines in scratch, in order, and
+ * offer their best XOR values to chunk's candidates.
+ * Short lines are searched in lane groups, and long lines are searched
+ * using their histograms. */
+static void
+search_lines(detect_scratch_t *scratch, size_t searchable_count,
+             double min_score, detect_chunk_t *chunk)
+{
+  line_batch_t * const batch = scratch->line_batch;
+  line_batch_clear(batch);
+
+  for (size_t i = 0; i < searchable_count; i++) {
+    const searchable_line_t * const current = &scratch->searchable[i];
+
+    /* Repeated lines are searched after the first copy, because they have
+     * the same promise and a later line. (Unless the first copy is still
+     * waiting in the line batch.) */
+    if (offer_cached_line(scratch->line_cache, current->hexstr,
+                          current->hexstr_len, current->line, chunk)) {
+      continue;
+    }
+
+    if (current->length > line_batch_line_length(batch)) {
+      search_line_histogram(current, min_score, scratch->line_cache, chunk);
+      continue;
+    }
+
+    line_batch_add(batch, &scratch->bytes[current->bytes_offset],
+                   current->length, i);
+
+    if (line_batch_is_full(batch)) {
+      search_line_batch(scratch, min_score, chunk);
+      line_batch_clear(batch);
+    }
+  }
+
+  if (line_batch_count(batch) > 0) {
+    search_line_batch(scratch, min_score, chunk);
+  }
+}
+
+/* Chunk Search */
+
+/* Return the length of the hex line at line_start, without its trailing
+ * non-hex characters (like "\r"). line_length excludes the newline. */
+static size_t
+hex_line_length(const char *line_start, size_t line_length)
+{
+  while (line_length > 0
+         && !is_hexchar_valid(line_start[line_length - 1],
+                              HEXCHAR_ACCEPT_ANY_CASE)) {
+    line_length--;
+  }
+
+  return line_length;
+}
+
+/* Decode and triage the hexstr_len characters at hexstr, which is line in
+ * its chunk. If the line can't be skipped, append it to scratch's
+ * searchable lines, and return true. */
+static bool
+triage_line(const char *hexstr, size_t hexstr_len, size_t line,
+            detect_scratch_t *scratch, size_t searchable_count)
+{
+  /* Lines are decoded into scratch space. Short lines are kept for line
+   * batches, but long lines only keep their histograms and keys. */
+  const size_t max_length = ceil_div(hexstr_len, HEXCHARS_PER_BYTE);
+  if (max_length > scratch->bytes_capacity - scratch->bytes_length) {
+    scratch->bytes_capacity = MAX(scratch->bytes_length + max_length,
+                                  scratch->bytes_capacity * 2);
+    scratch->bytes = realloc(scratch->bytes, scratch->bytes_capacity);
+    assert(scratch->bytes != NULL);
+  }
+
+  if (searchable_count == scratch->searchable_capacity) {
+    scratch->searchable_capacity = MAX(scratch->searchable_capacity * 2, 16);
+    scratch->searchable = realloc(scratch->searchable,
+                                  (scratch->searchable_capacity
+                                   * sizeof(*scratch->searchable)));
+    assert(scratch->searchable != NULL);
+  }
+
+  /* XOR only permutes the byte histogram, so the histogram is all we need
+   * to triage the line, and to score every different XOR value.
+   * Most lines have no XOR value that decrypts every byte to text, so find
+   * the surviving values while decoding, and reject the line before doing
+   * any scoring. */
+  searchable_line_t * const next = &scratch->searchable[searchable_count];
+  const size_t length = ingest_hex(hexstr, hexstr_len,
+                                   &scratch->bytes[scratch->bytes_length],
+                                   (scratch->bytes_capacity
+                                    - scratch->bytes_length),
+                                   &next->histogram, KEYSET_CLASS_TEXT,
+                                   &next->text_keys);
+
+  if (keyset_is_empty(&next->text_keys)) {
+    return false;
+  }
+
+  /* Most lines are random, so skip them before searching any keys */
+  triage_histogram(&next->histogram, &next->triage);
+  if (!is_triage_searchable(&next->triage)) {
+    return false;
+  }
+
+  next->line = line;
+  next->hexstr = hexstr;
+  next->hexstr_len = hexstr_len;
+  next->bytes_offset = scratch->bytes_length;
+  next->length = length;
+
+  if (length <= line_batch_line_length(scratch->line_batch)) {
+    scratch->bytes_length += length;
+  }
+
+  return true;
+}
+
+/* Find the best candidates in the chunk at index in the detect_job_t
+ * context. A parallel_task_func. */
+static void
+detect_chunk_task(size_t index, size_t thread_index, void *context)
+{
+  const detect_job_t *job = context;
+  assert(job != NULL);
+
+  detect_chunk_t * const chunk = &job->chunks[index];
+  detect_scratch_t * const scratch = &job->scratch[thread_index];
+
+  if (scratch->line_cache == NULL) {
+    /* A line can't have more results than XOR values */
+    scratch->line_cache = score_cache_alloc(DETECT_CACHED_LINE_COUNT,
+                                            MIN(job->candidate_count,
+                                                BYTE_VALUE_COUNT));
+    scratch->line_batch = line_batch_alloc(DETECT_BATCH_LINE_LENGTH,
+                                           LINE_BATCH_LANE_COUNT);
+    scratch->batch_scores = calloc(LINE_BATCH_LANE_COUNT,
+                                   sizeof(*scratch->batch_scores));
+    assert(scratch->batch_scores != NULL);
+  }
+
+  scratch->bytes_length = 0;
+
+  chunk->top_candidates = topk_alloc(job->candidate_count);
+  chunk->line_count = 0;
+
+  /* Triage each line in the chunk */
+  size_t searchable_count = 0;
+  const char *line_start = chunk->text;
+  const char * const chunk_end = chunk->text + chunk->length;
+
+  while (line_start < chunk_end) {
+    const char *line_end = memchr(line_start, '\n',
+                                  (size_t)(chunk_end - line_start));
+    if (line_end == NULL) {
+      line_end = chunk_end;
+    }
+
+    const size_t line = chunk->line_count;
+    const size_t hexstr_len = hex_line_length(line_start,
+                                              (size_t)(line_end
+                                                       - line_start));
+    chunk->line_count++;
+
+    /* Skip zero-length strings. Repeated lines have the same results, so we
+     * don't need to decode or score them again. */
+    if (hexstr_len > 0
+        && !offer_cached_line(scratch->line_cache, line_start, hexstr_len,
+                              line, chunk)) {
+      if (triage_line(line_start, hexstr_len, line, scratch,
+                      searchable_count)) {
+        searchable_count++;
+      } else {
+        score_cache_insert(scratch->line_cache, (const uint8_t *)line_start,
+                           hexstr_len, SCORE_MODEL_ENGLISH_HEURISTIC, NULL,
+                           0);
+      }
+    }
+
+    if (line_end == chunk_end) {
+      break;
+    }
+    line_start = line_end + 1;
+  }
+
+  /* Search the most promising lines first, so the bound rises quickly, and
+   * scoring stops early on the other lines */
+  if (searchable_count > 0) {
+    qsort(scratch->searchable, searchable_count,
+          sizeof(*scratch->searchable), &compare_searchable_lines);
+  }
+
+  search_lines(scratch, searchable_count, job->min_score, chunk);
+}
+
+/* Line Locations */
+
+/* Does top_candidates have a candidate for line? */
+static bool
+has_line_candidate(const topk_t *top_candidates, size_t line)
+{
+  for (size_t i = 0; i < top_candidates->count; i++) {
+    if (top_candidates->entries[i].line == line) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/* qsort() comparator for line locations, in line order. */
+static int
+compare_detect_lines(const void *a, const void *b)
+{
+  const detect_line_t *line_a = a;
+  const detect_line_t *line_b = b;
+
+  if (line_a->line != line_b->line) {
+    return line_a->line < line_b->line ? -1 : 1;
+  } else {
+    return 0;
+  }
+}
+
+/* Place the location of each different line in top_candidates in
+ * lines_out, in line order. The lines are found in the located lines of the
+ * chunk_count chunks, which are split from text.
+ * Returns the number of lines placed in lines_out. */
+static size_t
+locate_candidate_lines(const char *text, const detect_chunk_t *chunks,
+                       size_t chunk_count, const topk_t *top_candidates,
+                       detect_line_t *lines_out)
+{
+  size_t line_count = 0;
+
+  for (size_t i = 0; i < chunk_count; i++) {
+    const detect_chunk_t * const chunk = &chunks[i];
+
+    for (size_t j = 0; j < chunk->located_line_count; j++) {
+      const detect_line_t * const located = &chunk->located_lines[j];
+      const size_t line = chunk->first_line + located->line;
+
+      /* Most candidates kept by a chunk are replaced by better candidates
+       * from other chunks */
+      if (!has_line_candidate(top_candidates, line)) {
+        continue;
+      }
+
+      assert(line_count < top_candidates->count);
+      lines_out[line_count].line = line;
+      lines_out[line_count].offset = ((size_t)(chunk->text - text)
+                                      + located->offset);
+      lines_out[line_count].length = located->length;
+      line_count++;
+    }
+  }
+
+  if (line_count > 0) {
+    qsort(lines_out, line_count, sizeof(*lines_out), &compare_detect_lines);
+  }
+
+  return line_count;
+}
+
+/* Detection */
+
+/* Return the number of bytes in the chunk starting at text, which has
+ * length bytes left. Chunks end after a newline, or at the end of text. */
+static size_t
+chunk_length(const char *text, size_t length)
+{
+  if (length <= DETECT_CHUNK_LENGTH) {
+    return length;
+  }
+
+  const char *newline = memchr(text + DETECT_CHUNK_LENGTH - 1, '\n',
+                               length - (DETECT_CHUNK_LENGTH - 1));
+  if (newline == NULL) {
+    return length;
+  }
+
+  return (size_t)(newline - text) + 1;
+}
+
+/* Find the single-byte XOR keys that decrypt the hex lines in the length
+ * characters at text to English text, and offer the candidates scoring at
+ * least min_score to top_candidates. Lines are numbered from 0, including
+ * empty lines.
+ * The text is split into newline-aligned chunks, which are searched using
+ * up to thread_count threads (see parallel_thread_count()). Then the chunk
+ * results are merged in line order. The results in top_candidates don't
+ * depend on the thread count.
+ * The candidate count is the capacity of top_candidates, which must be
+ * empty.
+ * If lines_out isn't NULL, places the location of each different line in
+ * top_candidates in lines_out, in line order, and puts their count in
+ * line_count_out. lines_out must have room for the candidate count. */
+void
+detect_xor_lines(const char *text, size_t length, double min_score,
+                 size_t thread_count, topk_t *top_candidates,
+                 detect_line_t *lines_out, size_t *line_count_out)
+{
+  assert(text != NULL || length == 0);
+  assert(top_candidates != NULL);
+  assert(top_candidates->count == 0);
+  assert(lines_out == NULL || line_count_out != NULL);
+
+  if (lines_out != NULL) {
+    *line_count_out = 0;
+  }
+
+  if (length == 0) {
+    return;
+  }
+
+  /* Every chunk except the last is at least DETECT_CHUNK_LENGTH bytes */
+  const size_t max_chunk_count = ceil_div(length, DETECT_CHUNK_LENGTH);
+  detect_chunk_t *chunks = calloc(max_chunk_count, sizeof(*chunks));
+  assert(chunks != NULL);
+
+  size_t chunk_count = 0;
+  for (size_t offset = 0; offset < length; chunk_count++) {
+    assert(chunk_count < max_chunk_count);
+
+    chunks[chunk_count].text = text + offset;
+    chunks[chunk_count].length = chunk_length(text + offset,
+                                              length - offset);
+    offset += chunks[chunk_count].length;
+  }
+
+  const size_t threads = parallel_thread_count(thread_count);
+  detect_scratch_t *scratch = calloc(threads, sizeof(*scratch));
+  assert(scratch != NULL);
+
+  detect_job_t job;
+  job.chunks = chunks;
+  job.scratch = scratch;
+  job.min_score = min_score;
+  job.candidate_count = top_candidates->capacity;
+
+  parallel_for(chunk_count, threads, &detect_chunk_task, &job);
+
+  /* Number each chunk's lines after the lines in the previous chunks */
+  size_t first_line = 0;
+  for (size_t i = 0; i < chunk_count; i++) {
+    const topk_t *chunk_candidates = chunks[i].top_candidates;
+    chunks[i].first_line = first_line;
+
+    for (size_t j = 0; j < chunk_candidates->count; j++) {
+      const topk_entry_t *entry = &chunk_candidates->entries[j];
+      topk_offer(top_candidates, first_line + entry->line, entry->key,
+                 entry->score);
+    }
+
+    first_line += chunks[i].line_count;
+    topk_free(chunks[i].top_candidates);
+  }
+
+  if (lines_out != NULL) {
+    *line_count_out = locate_candidate_lines(text, chunks, chunk_count,
+                                             top_candidates, lines_out);
+  }
+
+  for (size_t i = 0; i < chunk_count; i++) {
+    free(chunks[i].located_lines);
+  }
+
+  for (size_t i = 0; i < threads; i++) {
+    free(scratch[i].bytes);
+    free(scratch[i].searchable);
+    score_cache_free(scratch[i].line_cache);
+    line_batch_free(scratch[i].line_batch);
+    free(scratch[i].batch_scores);
+  }
+
+  free(scratch);
+  free(chunks);
+}
+
+/* Map the file at path, and detect single-byte XORed lines in it, like
+ * detect_xor_lines(). Line locations are byte offsets in the file.
+ * Returns false if the file can't be opened or mapped. */
+bool
+detect_xor_lines_file(const char *path, double min_score,
+                      size_t thread_count, topk_t *top_candidates,
+                      detect_line_t *lines_out, size_t *line_count_out)
+{
+  assert(path != NULL);
+  assert(top_candidates != NULL);
+  assert(lines_out == NULL || line_count_out != NULL);
+
+  if (lines_out != NULL) {
+    *line_count_out = 0;
+  }
+
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < 0) {
+    close(fd);
+    return false;
+  }
+
+  /* Empty files can't be mapped, but they don't have any lines */
+  if (st.st_size == 0) {
+    close(fd);
+    return true;
+  }
+
+  const size_t mapping_length = (size_t)st.st_size;
+  void *mapping = mmap(NULL, mapping_length, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+
+  if (mapping == MAP_FAILED) {
+    return false;
+  }
+
+  /* Each chunk is read in order, so let the kernel read ahead */
+  (void)madvise(mapping, mapping_length, MADV_SEQUENTIAL);
+
+  detect_xor_lines(mapping, mapping_length, min_score, thread_count,
+                   top_candidates, lines_out, line_count_out);
+
+  int rv = munmap(mapping, mapping_length);
+  assert(rv == 0);
+
+  return true;
+}
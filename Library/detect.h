@@ -0,0 +1,67 @@
+//
+//  detect.h
+//  MatasanoCrypto
+//
+//  Created by Tim Wilson-Brown on 18/10/2026.
+//  Copyright © 2026 teor - gmail: teor2345
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef detect_h
+#define detect_h
+
+#include <stdbool.h>
+#include <sys/types.h>
+
+/* Forward Declarations */
+
+typedef struct topk_t topk_t;
+
+/* Detector Constants */
+
+/* Input is split into chunks of about this many bytes, which are extended
+ * to the end of their final line. Each chunk is a single parallel task. */
+#define DETECT_CHUNK_LENGTH (1024*1024)
+
+/* The number of distinct lines each thread remembers results for */
+#define DETECT_CACHED_LINE_COUNT 1024
+
+/* Lines of up to this many bytes are searched in lane groups (see
+ * line_batch_t). Longer lines are searched using their histograms, which
+ * takes the same time for any length. */
+#define DETECT_BATCH_LINE_LENGTH 64
+
+/* Data Types */
+
+/* Where a candidate line is in the detector's input */
+typedef struct detect_line_t {
+  size_t line;
+  /* The byte offset and length of the line's hex characters, without the
+   * newline or any other trailing non-hex characters */
+  size_t offset;
+  size_t length;
+} detect_line_t;
+
+/* Function Declarations */
+
+void detect_xor_lines(const char *text, size_t length, double min_score,
+                      size_t thread_count, topk_t *top_candidates,
+                      detect_line_t *lines_out, size_t *line_count_out);
+bool detect_xor_lines_file(const char *path, double min_score,
+                           size_t thread_count, topk_t *top_candidates,
+                           detect_line_t *lines_out,
+                           size_t *line_count_out);
+
+#endif /* detect_h */
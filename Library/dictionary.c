@@ -0,0 +1,422 @@
+//
+//  dictionary.c
+//  MatasanoCrypto
+//
+//  Created by Tim Wilson-Brown on 18/10/2026.
+//  Copyright © 2026 teor - gmail: teor2345
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "dictionary.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bytearray.h"
+#include "char.h"
+#include "histogram.h"
+#include "score.h"
+#include "topk.h"
+
+/* Private Constants */
+
+/* Marks a missing child or sibling */
+#define DICTIONARY_NO_NODE UINT32_MAX
+
+/* The root node, which has no letter */
+#define DICTIONARY_ROOT 0
+
+/* Stage 1 keeps at most this many keys for stage 2 */
+#define CASCADE_STAGE1_MAX_KEYS 16
+
+/* Private Data Types */
+
+/* A trie node. Each node's children are a linked list, so a node only needs
+ * two links, rather than one for every letter. */
+typedef struct dictionary_node_t {
+  uint32_t first_child;
+  uint32_t next_sibling;
+  /* A lowercase letter */
+  char letter;
+  /* Does a word end at this node? */
+  bool is_word;
+} dictionary_node_t;
+
+/* A case-insensitive set of words made of ASCII letters, stored as a trie.
+ * The nodes are in one array, and linked by index. */
+struct dictionary_t {
+  dictionary_node_t *nodes;
+  size_t node_count;
+  size_t node_capacity;
+  size_t word_count;
+};
+
+/* Allocation */
+
+/* Append a new node for letter to dictionary, and return its index. */
+static uint32_t
+dictionary_new_node(dictionary_t *dictionary, char letter)
+{
+  assert(dictionary != NULL);
+  assert(dictionary->node_count < DICTIONARY_NO_NODE);
+
+  if (dictionary->node_count == dictionary->node_capacity) {
+    dictionary->node_capacity *= 2;
+    dictionary->nodes = realloc(dictionary->nodes,
+                                (dictionary->node_capacity
+                                 * sizeof(*dictionary->nodes)));
+    assert(dictionary->nodes != NULL);
+  }
+
+  const uint32_t index = (uint32_t)dictionary->node_count;
+  dictionary_node_t * const node = &dictionary->nodes[index];
+  node->first_child = DICTIONARY_NO_NODE;
+  node->next_sibling = DICTIONARY_NO_NODE;
+  node->letter = letter;
+  node->is_word = false;
+  dictionary->node_count++;
+
+  return index;
+}
+
+/* Allocate and return a new, empty dictionary.
+ * The caller must free the dictionary using dictionary_free(). */
+dictionary_t *
+dictionary_alloc(void)
+{
+  dictionary_t *dictionary = malloc(sizeof(*dictionary));
+  assert(dictionary != NULL);
+
+  dictionary->node_capacity = 64;
+  dictionary->nodes = malloc(dictionary->node_capacity
+                             * sizeof(*dictionary->nodes));
+  assert(dictionary->nodes != NULL);
+  dictionary->node_count = 0;
+  dictionary->word_count = 0;
+
+  const uint32_t root = dictionary_new_node(dictionary, 0);
+  assert(root == DICTIONARY_ROOT);
+  (void)root;
+
+  return dictionary;
+}
+
+/* Free dictionary, which was allocated by dictionary_alloc() or
+ * dictionary_load().
+ * Use the dictionary_free() macro, which also sets dictionary to NULL. */
+void
+dictionary_free_(dictionary_t *dictionary)
+{
+  if (dictionary == NULL) {
+    return;
+  }
+
+  free(dictionary->nodes);
+  free(dictionary);
+}
+
+/* Trie */
+
+/* Return the lowercase version of byte, if it's an ASCII letter, or 0 if it
+ * isn't a letter. */
+static char
+dictionary_letter(uint8_t byte)
+{
+  if (!is_byte_ascii_letter(byte)) {
+    return 0;
+  }
+
+  char c = (char)byte;
+  return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+}
+
+/* Return the child of node with letter in dictionary, or DICTIONARY_NO_NODE
+ * if there isn't one. */
+static uint32_t
+dictionary_find_child(const dictionary_t *dictionary, uint32_t node,
+                      char letter)
+{
+  uint32_t child = dictionary->nodes[node].first_child;
+
+  while (child != DICTIONARY_NO_NODE
+         && dictionary->nodes[child].letter != letter) {
+    child = dictionary->nodes[child].next_sibling;
+  }
+
+  return child;
+}
+
+/* Add the nul-terminated word to dictionary. Case-insensitive.
+ * Returns false, and doesn't add the word, if it is empty or has any
+ * non-letters. */
+bool
+dictionary_add_word(dictionary_t *dictionary, const char *word)
+{
+  assert(dictionary != NULL);
+  assert(word != NULL);
+
+  const size_t length = strlen(word);
+  if (length == 0) {
+    return false;
+  }
+
+  for (size_t i = 0; i < length; i++) {
+    if (dictionary_letter((uint8_t)word[i]) == 0) {
+      return false;
+    }
+  }
+
+  uint32_t node = DICTIONARY_ROOT;
+  for (size_t i = 0; i < length; i++) {
+    const char letter = dictionary_letter((uint8_t)word[i]);
+    uint32_t child = dictionary_find_child(dictionary, node, letter);
+
+    if (child == DICTIONARY_NO_NODE) {
+      /* The new node might move the node array, so link it using indexes */
+      child = dictionary_new_node(dictionary, letter);
+      dictionary->nodes[child].next_sibling =
+                                        dictionary->nodes[node].first_child;
+      dictionary->nodes[node].first_child = child;
+    }
+
+    node = child;
+  }
+
+  if (!dictionary->nodes[node].is_word) {
+    dictionary->nodes[node].is_word = true;
+    dictionary->word_count++;
+  }
+
+  return true;
+}
+
+/* Is the nul-terminated word in dictionary? Case-insensitive. */
+bool
+dictionary_contains(const dictionary_t *dictionary, const char *word)
+{
+  assert(dictionary != NULL);
+  assert(word != NULL);
+
+  uint32_t node = DICTIONARY_ROOT;
+
+  for (size_t i = 0; word[i] != 0; i++) {
+    const char letter = dictionary_letter((uint8_t)word[i]);
+    if (letter == 0) {
+      return false;
+    }
+
+    node = dictionary_find_child(dictionary, node, letter);
+    if (node == DICTIONARY_NO_NODE) {
+      return false;
+    }
+  }
+
+  return node != DICTIONARY_ROOT && dictionary->nodes[node].is_word;
+}
+
+/* Return the number of words in dictionary. */
+size_t
+dictionary_word_count(const dictionary_t *dictionary)
+{
+  assert(dictionary != NULL);
+
+  return dictionary->word_count;
+}
+
+/* Load a dictionary from the word list file at path, which has one word per
+ * line. Skips lines that aren't words made of letters, and words longer than
+ * DICTIONARY_MAX_WORD_LENGTH.
+ * Returns NULL if the file can't be read.
+ * The caller must free the dictionary using dictionary_free(). */
+dictionary_t *
+dictionary_load(const char *path)
+{
+  assert(path != NULL);
+
+  FILE *f = fopen(path, "r");
+  if (f == NULL) {
+    return NULL;
+  }
+
+  dictionary_t *dictionary = dictionary_alloc();
+
+  /* The word, a newline, and a terminating nul */
+  char line[DICTIONARY_MAX_WORD_LENGTH + 2];
+  while (fgets(line, sizeof(line), f) != NULL) {
+    const size_t length = strcspn(line, "\r\n");
+
+    /* If the line didn't fit, discard the rest of it, so its tail isn't
+     * loaded as a separate word */
+    if (line[length] == 0 && !feof(f)) {
+      int c;
+      do {
+        c = fgetc(f);
+      } while (c != EOF && c != '\n');
+      continue;
+    }
+
+    line[length] = 0;
+    (void)dictionary_add_word(dictionary, line);
+  }
+
+  assert(!ferror(f));
+
+  int rv = fclose(f);
+  assert(rv == 0);
+  (void)rv;
+
+  return dictionary;
+}
+
+/* Word Scoring */
+
+/* Return the fraction of letters in the length bytes at bytes, XORed with
+ * key, that are in dictionary words.
+ * Words are runs of ASCII letters, so "MC's" is two words: "MC" and "s".
+ * Each letter is looked up as it is read, without copying the text.
+ * Returns 0.0 if there are no letters. */
+double
+dictionary_word_score_xor(const dictionary_t *dictionary,
+                          const uint8_t *bytes, size_t length, uint8_t key)
+{
+  assert(dictionary != NULL);
+  assert(bytes != NULL || length == 0);
+
+  size_t letter_count = 0;
+  size_t word_letter_count = 0;
+
+  /* The current run of letters, and its trie node, which is
+   * DICTIONARY_NO_NODE once the run can't be a word */
+  size_t run_length = 0;
+  uint32_t node = DICTIONARY_ROOT;
+
+  /* Go one past the end, so the final run ends */
+  for (size_t i = 0; i <= length; i++) {
+    const char letter = (i < length
+                         ? dictionary_letter((uint8_t)(bytes[i] ^ key))
+                         : 0);
+
+    if (letter != 0) {
+      run_length++;
+      if (node != DICTIONARY_NO_NODE) {
+        node = dictionary_find_child(dictionary, node, letter);
+      }
+      continue;
+    }
+
+    if (run_length > 0) {
+      letter_count += run_length;
+      if (node != DICTIONARY_NO_NODE && dictionary->nodes[node].is_word) {
+        word_letter_count += run_length;
+      }
+    }
+
+    run_length = 0;
+    node = DICTIONARY_ROOT;
+  }
+
+  assert(word_letter_count <= letter_count);
+
+  if (letter_count == 0) {
+    return 0.0;
+  }
+
+  return (double)word_letter_count / (double)letter_count;
+}
+
+/* Cascade Ranking */
+
+/* Is the cascade_result_t result better than the cascade_result_t other?
+ * Higher combined scores are better. Ties are broken by lower keys.
+ * A topk_better_func. */
+bool
+is_cascade_result_better(const void *result, const void *other)
+{
+  const cascade_result_t * const result_a = result;
+  const cascade_result_t * const result_b = other;
+  assert(result_a != NULL);
+  assert(result_b != NULL);
+
+  const double combined = result_a->score * result_a->word_score;
+  const double other_combined = result_b->score * result_b->word_score;
+
+  if (combined != other_combined) {
+    return combined > other_combined;
+  } else {
+    return result_a->key < result_b->key;
+  }
+}
+
+/* Rank the single-byte XOR keys for ciphertext in two stages, and place
+ * the best ranked_count keys in ranked_out, best first.
+ * Stage 1 scores every key from the ciphertext histogram, and keeps the
+ * best keys with a score of at least min_score. Stage 2 only decrypts those
+ * keys, and keeps the ones where at least min_word_score of the letters are
+ * in dictionary words.
+ * The results are ranked by the product of both scores.
+ * Returns the number of results. */
+size_t
+cascade_rank_keys(const dictionary_t *dictionary,
+                  const bytearray_t *ciphertext, double min_score,
+                  double min_word_score, cascade_result_t *ranked_out,
+                  size_t ranked_count)
+{
+  assert(dictionary != NULL);
+  assert(ciphertext != NULL);
+  assert(is_bytearray_consistent(ciphertext));
+  assert(ranked_out != NULL || ranked_count == 0);
+
+  if (bytearray_length(ciphertext) == 0 || ranked_count == 0) {
+    return 0;
+  }
+
+  /* Stage 1: histogram scores */
+  byte_histogram_t histogram;
+  bytearray_histogram(ciphertext, &histogram);
+
+  key_score_t stage1[CASCADE_STAGE1_MAX_KEYS];
+  const size_t stage1_count = score_english_histogram_top_keys(
+                                                      &histogram, stage1,
+                                                      CASCADE_STAGE1_MAX_KEYS);
+
+  /* Stage 2: dictionary words, in the survivors of stage 1 */
+  const byte_view_t view = bytearray_view(ciphertext);
+  size_t result_count = 0;
+
+  for (size_t i = 0; i < stage1_count; i++) {
+    if (stage1[i].score < min_score) {
+      continue;
+    }
+
+    cascade_result_t result;
+    result.key = stage1[i].key;
+    result.score = stage1[i].score;
+    result.word_score = dictionary_word_score_xor(dictionary, view.bytes,
+                                                  view.length, result.key);
+
+    if (result.word_score < min_word_score) {
+      continue;
+    }
+
+    result_count = topk_insert_sorted(ranked_out, result_count,
+                                      ranked_count, sizeof(*ranked_out),
+                                      &result, &is_cascade_result_better);
+  }
+
+  assert(result_count <= ranked_count);
+  return result_count;
+}
@@ -0,0 +1,79 @@
+//
+//  dictionary.h
+//  MatasanoCrypto
+//
+//  Created by Tim Wilson-Brown on 18/10/2026.
+//  Copyright © 2026 teor - gmail: teor2345
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef dictionary_h
+#define dictionary_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/* Forward Declarations */
+
+typedef struct bytearray_t bytearray_t;
+typedef struct dictionary_t dictionary_t;
+
+/* Dictionary Constants */
+
+/* The default word list file name. The "Copy Files" build phase puts it in
+ * the products directory. */
+#define DICTIONARY_DEFAULT_PATH "words.txt"
+
+/* The longest word we load from a word list */
+#define DICTIONARY_MAX_WORD_LENGTH 64
+
+/* Data Types */
+
+/* A single-byte XOR key that passed both cascade stages */
+typedef struct cascade_result_t {
+  uint8_t key;
+  /* The stage 1 score: score_english_text() */
+  double score;
+  /* The stage 2 score: dictionary_word_score_xor() */
+  double word_score;
+} cascade_result_t;
+
+/* Function Declarations */
+
+dictionary_t *dictionary_alloc(void);
+void dictionary_free_(dictionary_t *dictionary);
+#define dictionary_free(dictionary) \
+  do { \
+    dictionary_free_(dictionary); \
+    dictionary = NULL; \
+  } while (0)
+
+dictionary_t *dictionary_load(const char *path);
+bool dictionary_add_word(dictionary_t *dictionary, const char *word);
+bool dictionary_contains(const dictionary_t *dictionary, const char *word);
+size_t dictionary_word_count(const dictionary_t *dictionary);
+
+double dictionary_word_score_xor(const dictionary_t *dictionary,
+                                 const uint8_t *bytes, size_t length,
+                                 uint8_t key);
+
+bool is_cascade_result_better(const void *result, const void *other);
+size_t cascade_rank_keys(const dictionary_t *dictionary,
+                         const bytearray_t *ciphertext, double min_score,
+                         double min_word_score, cascade_result_t *ranked_out,
+                         size_t ranked_count);
+
+#endif /* dictionary_h */
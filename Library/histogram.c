@@ -0,0 +1,310 @@
+//
+//  histogram.c
+//  MatasanoCrypto
+//
+//  Created by Tim Wilson-Brown on 18/10/2026.
+//  Copyright © 2026 teor - gmail: teor2345
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "histogram.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "bytearray.h"
+#include "cpu.h"
+
+#if CPU_DISPATCH_X86
+#include <immintrin.h>
+#endif
+
+/* Histogram Kernel */
+
+/* Counting into a single table stalls when the same byte value repeats,
+ * because each increment has to wait for the previous store to the same
+ * counter. Text repeats bytes constantly. So long inputs are counted into
+ * interleaved sub-tables, which are merged at the end. */
+#define HISTOGRAM_SUBTABLE_COUNT 4
+
+/* Inputs shorter than this are counted directly, because clearing and
+ * merging the sub-tables takes longer than counting them */
+#define HISTOGRAM_SUBTABLE_MIN_LENGTH 512
+
+/* Sub-table counts are 32 bits, so inputs are counted in chunks of at most
+ * this many bytes. (Each sub-table counts at most a quarter of each chunk.)
+ */
+#define HISTOGRAM_SUBTABLE_MAX_LENGTH ((size_t)UINT32_MAX)
+
+typedef uint32_t histogram_subtables_t[HISTOGRAM_SUBTABLE_COUNT]
+                                      [BYTE_VALUE_COUNT];
+
+/* Load a possibly unaligned uint64_t from bytes. */
+static inline uint64_t
+load_word(const uint8_t *bytes)
+{
+  uint64_t word = 0;
+  memcpy(&word, bytes, sizeof(word));
+  return word;
+}
+
+/* Add the counts of the length bytes at bytes to subtables.
+ * Consecutive bytes are counted in different sub-tables. The byte order of
+ * each word doesn't matter, because every byte is counted. */
+static void
+count_subtables(histogram_subtables_t subtables, const uint8_t *bytes,
+                size_t length)
+{
+  assert(length <= HISTOGRAM_SUBTABLE_MAX_LENGTH);
+
+  size_t i = 0;
+
+  for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t)) {
+    const uint64_t word = load_word(&bytes[i]);
+
+    subtables[0][(uint8_t)word]++;
+    subtables[1][(uint8_t)(word >> 8)]++;
+    subtables[2][(uint8_t)(word >> 16)]++;
+    subtables[3][(uint8_t)(word >> 24)]++;
+    subtables[0][(uint8_t)(word >> 32)]++;
+    subtables[1][(uint8_t)(word >> 40)]++;
+    subtables[2][(uint8_t)(word >> 48)]++;
+    subtables[3][(uint8_t)(word >> 56)]++;
+  }
+
+  for (; i < length; i++) {
+    subtables[i % HISTOGRAM_SUBTABLE_COUNT][bytes[i]]++;
+  }
+}
+
+#if CPU_DISPATCH_X86 && SIZE_T_MAX == UINT64_MAX
+
+/* merge_subtables(), summing 8 bytes' sub-table counts at a time, then
+ * widening them to 64 bits. */
+CPU_TARGET("avx2") static void
+merge_subtables_avx2(size_t counts[BYTE_VALUE_COUNT],
+                     const histogram_subtables_t subtables, bool subtract)
+{
+  for (size_t b = 0; b < BYTE_VALUE_COUNT; b += 8) {
+    __m256i sum = _mm256_loadu_si256((const __m256i *)&subtables[0][b]);
+    for (size_t t = 1; t < HISTOGRAM_SUBTABLE_COUNT; t++) {
+      sum = _mm256_add_epi32(sum, _mm256_loadu_si256(
+                                        (const __m256i *)&subtables[t][b]));
+    }
+
+    const __m256i low = _mm256_cvtepu32_epi64(_mm256_castsi256_si128(sum));
+    const __m256i high = _mm256_cvtepu32_epi64(
+                                        _mm256_extracti128_si256(sum, 1));
+    __m256i counts_low = _mm256_loadu_si256((const __m256i *)&counts[b]);
+    __m256i counts_high = _mm256_loadu_si256((const __m256i *)&counts[b + 4]);
+
+    if (subtract) {
+      counts_low = _mm256_sub_epi64(counts_low, low);
+      counts_high = _mm256_sub_epi64(counts_high, high);
+    } else {
+      counts_low = _mm256_add_epi64(counts_low, low);
+      counts_high = _mm256_add_epi64(counts_high, high);
+    }
+
+    _mm256_storeu_si256((__m256i *)&counts[b], counts_low);
+    _mm256_storeu_si256((__m256i *)&counts[b + 4], counts_high);
+  }
+}
+
+#endif
+
+/* Merge subtables into counts, adding them, or subtracting them if subtract
+ * is true. */
+static void
+merge_subtables(size_t counts[BYTE_VALUE_COUNT],
+                const histogram_subtables_t subtables, bool subtract)
+{
+#if CPU_DISPATCH_X86 && SIZE_T_MAX == UINT64_MAX
+  if (CPU_SUPPORTS("avx2")) {
+    merge_subtables_avx2(counts, subtables, subtract);
+    return;
+  }
+#endif
+
+  for (size_t b = 0; b < BYTE_VALUE_COUNT; b++) {
+    size_t sum = 0;
+    for (size_t t = 0; t < HISTOGRAM_SUBTABLE_COUNT; t++) {
+      sum += subtables[t][b];
+    }
+
+    if (subtract) {
+      assert(counts[b] >= sum);
+      counts[b] -= sum;
+    } else {
+      counts[b] += sum;
+    }
+  }
+}
+
+/* Add the counts of the length bytes at bytes to counts, or subtract them if
+ * subtract is true. */
+static void
+update_counts(size_t counts[BYTE_VALUE_COUNT], const uint8_t *bytes,
+              size_t length, bool subtract)
+{
+  if (length < HISTOGRAM_SUBTABLE_MIN_LENGTH) {
+    for (size_t i = 0; i < length; i++) {
+      if (subtract) {
+        assert(counts[bytes[i]] > 0);
+        counts[bytes[i]]--;
+      } else {
+        counts[bytes[i]]++;
+      }
+    }
+    return;
+  }
+
+  histogram_subtables_t subtables;
+
+  while (length > 0) {
+    const size_t chunk_length = (length > HISTOGRAM_SUBTABLE_MAX_LENGTH
+                                 ? HISTOGRAM_SUBTABLE_MAX_LENGTH
+                                 : length);
+
+    memset(subtables, 0, sizeof(subtables));
+    count_subtables(subtables, bytes, chunk_length);
+    merge_subtables(counts, (const uint32_t (*)[BYTE_VALUE_COUNT])subtables,
+                    subtract);
+
+    bytes += chunk_length;
+    length -= chunk_length;
+  }
+}
+
+/* Histogram Functions */
+
+/* Set every count in histogram to zero. */
+void
+byte_histogram_clear(byte_histogram_t *histogram)
+{
+  assert(histogram != NULL);
+
+  memset(histogram, 0, sizeof(*histogram));
+}
+
+/* Count the length bytes at bytes, and add them to histogram.
+ * Runs close to memory bandwidth on long inputs, even when bytes repeat. */
+void
+byte_histogram_add_bytes(byte_histogram_t *histogram, const uint8_t *bytes,
+                         size_t length)
+{
+  assert(histogram != NULL);
+  assert(bytes != NULL || length == 0);
+  assert(histogram->length <= SIZE_T_MAX - length);
+
+  update_counts(histogram->counts, bytes, length, false);
+  histogram->length += length;
+}
+
+/* Count the length bytes at bytes, and subtract them from histogram.
+ * bytes must have previously been added to histogram. */
+void
+byte_histogram_remove_bytes(byte_histogram_t *histogram,
+                            const uint8_t *bytes, size_t length)
+{
+  assert(histogram != NULL);
+  assert(bytes != NULL || length == 0);
+  assert(histogram->length >= length);
+
+  update_counts(histogram->counts, bytes, length, true);
+  histogram->length -= length;
+}
+
+/* Add byte to histogram. */
+void
+byte_histogram_add_byte(byte_histogram_t *histogram, uint8_t byte)
+{
+  assert(histogram != NULL);
+  assert(histogram->length < SIZE_T_MAX);
+
+  histogram->counts[byte]++;
+  histogram->length++;
+}
+
+/* Subtract byte from histogram.
+ * byte must have previously been added to histogram. */
+void
+byte_histogram_remove_byte(byte_histogram_t *histogram, uint8_t byte)
+{
+  assert(histogram != NULL);
+  assert(histogram->counts[byte] > 0);
+  assert(histogram->length > 0);
+
+  histogram->counts[byte]--;
+  histogram->length--;
+}
+
+/* Add every count in other to histogram. */
+void
+byte_histogram_add(byte_histogram_t *histogram,
+                   const byte_histogram_t *other)
+{
+  assert(histogram != NULL);
+  assert(other != NULL);
+  assert(histogram->length <= SIZE_T_MAX - other->length);
+
+  for (size_t b = 0; b < BYTE_VALUE_COUNT; b++) {
+    histogram->counts[b] += other->counts[b];
+  }
+  histogram->length += other->length;
+}
+
+/* Subtract every count in other from histogram.
+ * other's bytes must have previously been added to histogram. */
+void
+byte_histogram_subtract(byte_histogram_t *histogram,
+                        const byte_histogram_t *other)
+{
+  assert(histogram != NULL);
+  assert(other != NULL);
+  assert(histogram->length >= other->length);
+
+  for (size_t b = 0; b < BYTE_VALUE_COUNT; b++) {
+    assert(histogram->counts[b] >= other->counts[b]);
+    histogram->counts[b] -= other->counts[b];
+  }
+  histogram->length -= other->length;
+}
+
+/* Count the bytes in bytearray, and place the counts in histogram_out.
+ * This is a single pass over the data: every statistic derived from the
+ * histogram is then independent of the length of bytearray. */
+void
+bytearray_histogram(const bytearray_t *bytearray,
+                    byte_histogram_t *histogram_out)
+{
+  assert(bytearray != NULL);
+  assert(is_bytearray_consistent(bytearray));
+  assert(histogram_out != NULL);
+
+  byte_histogram_clear(histogram_out);
+
+  if (bytearray_length(bytearray) > 0) {
+    byte_histogram_add_bytes(histogram_out,
+                             bytearray_const_pointer_checked(
+                                                bytearray, 0,
+                                                bytearray_length(bytearray)),
+                             bytearray_length(bytearray));
+  }
+
+  assert(histogram_out->length == bytearray_length(bytearray));
+}
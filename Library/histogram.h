@@ -0,0 +1,58 @@
+//
+//  histogram.h
+//  MatasanoCrypto
+//
+//  Created by Tim Wilson-Brown on 18/10/2026.
+//  Copyright © 2026 teor - gmail: teor2345
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef histogram_h
+#define histogram_h
+
+#include <sys/types.h>
+
+#include "char.h"
+
+/* Forward Declarations */
+
+typedef struct bytearray_t bytearray_t;
+
+/* Data Types */
+
+/* The number of times each byte value occurs in some data */
+typedef struct byte_histogram_t {
+  /* The total number of bytes counted, which is the sum of counts */
+  size_t length;
+  size_t counts[BYTE_VALUE_COUNT];
+} byte_histogram_t;
+
+/* Function Declarations */
+
+void byte_histogram_clear(byte_histogram_t *histogram);
+void byte_histogram_add_bytes(byte_histogram_t *histogram,
+                              const uint8_t *bytes, size_t length);
+void byte_histogram_remove_bytes(byte_histogram_t *histogram,
+                                 const uint8_t *bytes, size_t length);
+void byte_histogram_add_byte(byte_histogram_t *histogram, uint8_t byte);
+void byte_histogram_remove_byte(byte_histogram_t *histogram, uint8_t byte);
+void byte_histogram_add(byte_histogram_t *histogram,
+                        const byte_histogram_t *other);
+void byte_histogram_subtract(byte_histogram_t *histogram,
+                             const byte_histogram_t *other);
+void bytearray_histogram(const bytearray_t *bytearray,
+                         byte_histogram_t *histogram_out);
+
+#endif /* histogram_h */
@@ -0,0 +1,113 @@
+//
+//  ingest.c
+//  MatasanoCrypto
+//
+//  Created by Tim Wilson-Brown on 18/10/2026.
+//  Copyright © 2026 teor - gmail: teor2345
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "ingest.h"
+
+#include <assert.h>
+#include <stdbool.h>
+
+#include "calc.h"
+#include "char.h"
+#include "hex.h"
+#include "histogram.h"
+
+/* Hex Decoding */
+
+/* Marks characters that aren't hex digits */
+#define INGEST_INVALID_NYBBLE 0xff
+
+/* Each character's hex digit value, or INGEST_INVALID_NYBBLE.
+ * Accepts lowercase and uppercase, like hexpair_to_byte(). */
+#define HEX_NYBBLE(c) \
+  ((c) >= '0' && (c) <= '9' ? (c) - '0' \
+   : ((c) >= 'a' && (c) <= 'f' ? (c) - 'a' + 10 \
+      : ((c) >= 'A' && (c) <= 'F' ? (c) - 'A' + 10 \
+         : INGEST_INVALID_NYBBLE)))
+
+static const uint8_t hex_nybble_table[BYTE_VALUE_COUNT] = {
+  BYTE_TABLE(HEX_NYBBLE)
+};
+
+/* Return the value of the hex digit hexchar. */
+static uint8_t
+ingest_nybble(char hexchar)
+{
+  const uint8_t nybble = hex_nybble_table[(uint8_t)hexchar];
+  assert(nybble != INGEST_INVALID_NYBBLE);
+  return nybble;
+}
+
+/* Fused Ingest */
+
+/* Decode the first hexstr_len characters of hexstr into bytes_out, count
+ * the decoded bytes in histogram_out, and (if keys_out is not NULL) put the
+ * single-byte XOR keys that decrypt every byte to keyset_class in keys_out.
+ * This is one pass: each decoded byte is only touched once, while it is in
+ * a register. The decoded bytes are still written to bytes_out, so callers
+ * can copy them if the line survives their filters.
+ * bytes_out is caller-provided scratch of at least bytes_capacity bytes,
+ * which must hold every decoded byte.
+ * Decodes like hexstr_to_bytearray(): an odd final character is the high
+ * nybble of the final byte. Every character must be a hex digit.
+ * Returns the number of decoded bytes. */
+size_t
+ingest_hex(const char *hexstr, size_t hexstr_len, uint8_t *bytes_out,
+           size_t bytes_capacity, byte_histogram_t *histogram_out,
+           keyset_class_t keyset_class, keyset_t *keys_out)
+{
+  assert(hexstr != NULL || hexstr_len == 0);
+  assert(bytes_out != NULL || bytes_capacity == 0);
+  assert(histogram_out != NULL);
+
+  const size_t length = ceil_div(hexstr_len, HEXCHARS_PER_BYTE);
+  assert(length <= bytes_capacity);
+
+  byte_histogram_clear(histogram_out);
+
+  /* Once no keys survive, stop intersecting */
+  bool keys_live = (keys_out != NULL);
+  if (keys_live) {
+    keyset_fill(keys_out);
+  }
+
+  for (size_t i = 0; i < length; i++) {
+    const size_t hexstr_pos = i * HEXCHARS_PER_BYTE;
+
+    /* if we're missing a hexchar for the final byte, act like it's '0' */
+    const uint8_t msb = ingest_nybble(hexstr[hexstr_pos]);
+    const uint8_t lsb = (hexstr_pos + 1 < hexstr_len
+                         ? ingest_nybble(hexstr[hexstr_pos + 1])
+                         : 0);
+    const uint8_t byte = (uint8_t)(msb << HEX_BIT) | lsb;
+
+    bytes_out[i] = byte;
+    histogram_out->counts[byte]++;
+
+    if (keys_live) {
+      keyset_intersect(keys_out, keyset_for_byte(keyset_class, byte));
+      keys_live = !keyset_is_empty(keys_out);
+    }
+  }
+
+  histogram_out->length = length;
+
+  return length;
+}
@@ -0,0 +1,40 @@
+//
+//  ingest.h
+//  MatasanoCrypto
+//
+//  Created by Tim Wilson-Brown on 18/10/2026.
+//  Copyright © 2026 teor - gmail: teor2345
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef ingest_h
+#define ingest_h
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "keyset.h"
+
+/* Forward Declarations */
+
+typedef struct byte_histogram_t byte_histogram_t;
+
+/* Function Declarations */
+
+size_t ingest_hex(const char *hexstr, size_t hexstr_len, uint8_t *bytes_out,
+                  size_t bytes_capacity, byte_histogram_t *histogram_out,
+                  keyset_class_t keyset_class, keyset_t *keys_out);
+
+#endif /* ingest_h */
@@ -0,0 +1,238 @@
+//
+//  keyset.c
+//  MatasanoCrypto
+//
+//  Created by Tim Wilson-Brown on 18/10/2026.
+//  Copyright © 2026 teor - gmail: teor2345
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "keyset.h"
+
+#include <assert.h>
+#include <pthread.h>
+#include <string.h>
+
+#include "histogram.h"
+
+/* Key Set Operations */
+
+/* Return the word index and bit mask of key in a keyset */
+#define KEYSET_WORD(key) ((key) / KEYSET_WORD_BITS)
+#define KEYSET_BIT(key)  (((uint64_t)1) << ((key) % KEYSET_WORD_BITS))
+
+/* Remove every key from keyset. */
+void
+keyset_clear(keyset_t *keyset)
+{
+  assert(keyset != NULL);
+
+  memset(keyset->words, 0, sizeof(keyset->words));
+}
+
+/* Add every key to keyset. */
+void
+keyset_fill(keyset_t *keyset)
+{
+  assert(keyset != NULL);
+
+  memset(keyset->words, 0xff, sizeof(keyset->words));
+}
+
+/* Add key to keyset. */
+void
+keyset_add(keyset_t *keyset, uint8_t key)
+{
+  assert(keyset != NULL);
+
+  keyset->words[KEYSET_WORD(key)] |= KEYSET_BIT(key);
+}
+
+/* Is key in keyset? */
+bool
+keyset_contains(const keyset_t *keyset, uint8_t key)
+{
+  assert(keyset != NULL);
+
+  return (keyset->words[KEYSET_WORD(key)] & KEYSET_BIT(key)) != 0;
+}
+
+/* Is keyset empty? */
+bool
+keyset_is_empty(const keyset_t *keyset)
+{
+  assert(keyset != NULL);
+
+  uint64_t any = 0;
+  for (size_t i = 0; i < KEYSET_WORD_COUNT; i++) {
+    any |= keyset->words[i];
+  }
+
+  return any == 0;
+}
+
+/* Return the number of keys in keyset. */
+size_t
+keyset_count(const keyset_t *keyset)
+{
+  assert(keyset != NULL);
+
+  size_t count = 0;
+  for (size_t i = 0; i < KEYSET_WORD_COUNT; i++) {
+    count += (size_t)__builtin_popcountll(keyset->words[i]);
+  }
+
+  assert(count <= BYTE_VALUE_COUNT);
+  return count;
+}
+
+/* Remove every key that isn't in other from keyset. */
+void
+keyset_intersect(keyset_t *keyset, const keyset_t *other)
+{
+  assert(keyset != NULL);
+  assert(other != NULL);
+
+  for (size_t i = 0; i < KEYSET_WORD_COUNT; i++) {
+    keyset->words[i] &= other->words[i];
+  }
+}
+
+/* Add every key in other to keyset. */
+void
+keyset_union(keyset_t *keyset, const keyset_t *other)
+{
+  assert(keyset != NULL);
+  assert(other != NULL);
+
+  for (size_t i = 0; i < KEYSET_WORD_COUNT; i++) {
+    keyset->words[i] |= other->words[i];
+  }
+}
+
+/* Key Set Tables */
+
+/* For each class and ciphertext byte, the keys that decrypt that byte to a
+ * plaintext byte in the class. 16 kB in total. */
+static keyset_t keyset_table[KEYSET_CLASS_COUNT][BYTE_VALUE_COUNT];
+static pthread_once_t keyset_table_once = PTHREAD_ONCE_INIT;
+
+/* Is byte an allowed plaintext byte in keyset_class? */
+static bool
+is_byte_in_keyset_class(keyset_class_t keyset_class, uint8_t byte)
+{
+  const char c = (char)byte;
+
+  switch (keyset_class) {
+    case KEYSET_CLASS_TEXT:
+      return ((c >= ' ' && c <= '~')
+              || c == '\t' || c == '\n' || c == '\r');
+    case KEYSET_CLASS_LETTER_SPACE:
+      return ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == ' ');
+    case KEYSET_CLASS_COUNT:
+    default:
+      assert(false);
+      return false;
+  }
+}
+
+/* Fill in keyset_table. Only call this using pthread_once(). */
+static void
+keyset_table_init(void)
+{
+  for (size_t class_index = 0; class_index < KEYSET_CLASS_COUNT;
+       class_index++) {
+    /* The keys that decrypt byte 0 are the allowed plaintext bytes, and XOR
+     * maps them to the keys for every other byte */
+    for (size_t byte = 0; byte < BYTE_VALUE_COUNT; byte++) {
+      keyset_t * const keyset = &keyset_table[class_index][byte];
+      keyset_clear(keyset);
+
+      for (size_t plain = 0; plain < BYTE_VALUE_COUNT; plain++) {
+        if (is_byte_in_keyset_class((keyset_class_t)class_index,
+                                    (uint8_t)plain)) {
+          keyset_add(keyset, (uint8_t)(plain ^ byte));
+        }
+      }
+    }
+  }
+}
+
+/* Return the set of keys that decrypt the ciphertext byte to a plaintext
+ * byte in keyset_class. The table is built on first use, and is safe to use
+ * from multiple threads. */
+const keyset_t *
+keyset_for_byte(keyset_class_t keyset_class, uint8_t byte)
+{
+  assert(keyset_class < KEYSET_CLASS_COUNT);
+
+  int rv = pthread_once(&keyset_table_once, &keyset_table_init);
+  assert(rv == 0);
+  (void)rv;
+
+  return &keyset_table[keyset_class][byte];
+}
+
+/* Find the single-byte XOR keys that decrypt every one of the length bytes
+ * at bytes to a plaintext byte in keyset_class, and put them in keys_out.
+ * Stops as soon as no keys are left, so most non-text inputs are rejected
+ * after a few bytes.
+ * Returns true if any keys survive. */
+bool
+keyset_surviving_keys(const uint8_t *bytes, size_t length,
+                      keyset_class_t keyset_class, keyset_t *keys_out)
+{
+  assert(bytes != NULL || length == 0);
+  assert(keys_out != NULL);
+
+  keyset_fill(keys_out);
+
+  for (size_t i = 0; i < length; i++) {
+    keyset_intersect(keys_out, keyset_for_byte(keyset_class, bytes[i]));
+
+    if (keyset_is_empty(keys_out)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/* Like keyset_surviving_keys(), but for the bytes counted in histogram.
+ * Each distinct byte value is only checked once. */
+bool
+keyset_surviving_keys_histogram(const byte_histogram_t *histogram,
+                                keyset_class_t keyset_class,
+                                keyset_t *keys_out)
+{
+  assert(histogram != NULL);
+  assert(keys_out != NULL);
+
+  keyset_fill(keys_out);
+
+  for (size_t byte = 0; byte < BYTE_VALUE_COUNT; byte++) {
+    if (histogram->counts[byte] == 0) {
+      continue;
+    }
+
+    keyset_intersect(keys_out, keyset_for_byte(keyset_class, (uint8_t)byte));
+
+    if (keyset_is_empty(keys_out)) {
+      return false;
+    }
+  }
+
+  return true;
+}
@@ -0,0 +1,74 @@
+//
+//  keyset.h
+//  MatasanoCrypto
+//
+//  Created by Tim Wilson-Brown on 18/10/2026.
+//  Copyright © 2026 teor - gmail: teor2345
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef keyset_h
+#define keyset_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "char.h"
+
+/* Forward Declarations */
+
+typedef struct byte_histogram_t byte_histogram_t;
+
+/* Key Set Constants */
+
+#define KEYSET_WORD_BITS 64
+#define KEYSET_WORD_COUNT (BYTE_VALUE_COUNT / KEYSET_WORD_BITS)
+
+/* Data Types */
+
+/* A set of single-byte XOR keys, one bit per key value */
+typedef struct keyset_t {
+  uint64_t words[KEYSET_WORD_COUNT];
+} keyset_t;
+
+/* The plaintext bytes that a key is allowed to produce */
+typedef enum keyset_class_t {
+  /* Printable ASCII, tab, newline, and carriage return */
+  KEYSET_CLASS_TEXT,
+  /* ASCII letters and space */
+  KEYSET_CLASS_LETTER_SPACE,
+  KEYSET_CLASS_COUNT
+} keyset_class_t;
+
+/* Function Declarations */
+
+void keyset_clear(keyset_t *keyset);
+void keyset_fill(keyset_t *keyset);
+void keyset_add(keyset_t *keyset, uint8_t key);
+bool keyset_contains(const keyset_t *keyset, uint8_t key);
+bool keyset_is_empty(const keyset_t *keyset);
+size_t keyset_count(const keyset_t *keyset);
+void keyset_intersect(keyset_t *keyset, const keyset_t *other);
+void keyset_union(keyset_t *keyset, const keyset_t *other);
+
+const keyset_t *keyset_for_byte(keyset_class_t keyset_class, uint8_t byte);
+bool keyset_surviving_keys(const uint8_t *bytes, size_t length,
+                           keyset_class_t keyset_class, keyset_t *keys_out);
+bool keyset_surviving_keys_histogram(const byte_histogram_t *histogram,
+                                     keyset_class_t keyset_class,
+                                     keyset_t *keys_out);
+
+#endif /* keyset_h */
@@ -0,0 +1,470 @@
+//
+//  keysize.c
+//  MatasanoCrypto
+//
+//  Created by Tim Wilson-Brown on 18/10/2026.
+//  Copyright © 2026 teor - gmail: teor2345
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "keysize.h"
+
+#include <assert.h>
+#include <float.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bit_ops.h"
+#include "bytearray.h"
+#include "char.h"
+#include "parallel.h"
+
+/* Private Data Types */
+
+/* The running totals for a single keysize */
+typedef struct keysize_state_t {
+  size_t keysize;
+  /* The first block of the next pair to compare */
+  size_t next_block;
+  size_t bit_total;
+  size_t pair_count;
+} keysize_state_t;
+
+/* The shared state for comparing a chunk of ciphertext */
+typedef struct keysize_chunk_job_t {
+  const uint8_t *bytes;
+  size_t length;
+  /* Pairs that start before chunk_end are compared in this chunk */
+  size_t chunk_end;
+  size_t max_pairs;
+  keysize_state_t *states;
+} keysize_chunk_job_t;
+
+/* The shared state for finding the index of coincidence of every keysize */
+typedef struct keysize_coincidence_job_t {
+  const uint8_t *bytes;
+  size_t length;
+  size_t max_keysize;
+  keysize_score_t *scores;
+  /* Each thread's column counts, allocated by the thread for max_keysize
+   * columns */
+  uint16_t **column_counts;
+} keysize_coincidence_job_t;
+
+/* Set options to the defaults: the challenge keysize range, all pairs,
+ * stopping after the best 3 keysizes are stable for 4 chunks, and one
+ * thread per CPU. */
+void
+keysize_options_init(keysize_options_t *options)
+{
+  assert(options != NULL);
+
+  memset(options, 0, sizeof(*options));
+  options->min_keysize = KEYSIZE_MIN_DEFAULT;
+  options->max_keysize = KEYSIZE_MAX_DEFAULT;
+  options->max_pairs = 0;
+  options->stable_chunks = 4;
+  options->stable_top = 3;
+  options->thread_count = PARALLEL_THREADS_AUTO;
+}
+
+/* Order keysize scores by ascending distance, then ascending keysize. */
+static int
+keysize_score_compare(const void *a, const void *b)
+{
+  const keysize_score_t * const score_a = a;
+  const keysize_score_t * const score_b = b;
+
+  if (score_a->distance < score_b->distance) {
+    return -1;
+  } else if (score_a->distance > score_b->distance) {
+    return 1;
+  } else if (score_a->keysize < score_b->keysize) {
+    return -1;
+  } else if (score_a->keysize > score_b->keysize) {
+    return 1;
+  }
+
+  return 0;
+}
+
+/* Sort count scores from best (lowest distance) to worst.
+ * Ties are broken by preferring the shorter keysize. */
+void
+keysize_sort_scores(keysize_score_t *scores, size_t count)
+{
+  assert(scores != NULL || count == 0);
+
+  if (count > 1) {
+    qsort(scores, count, sizeof(*scores), &keysize_score_compare);
+  }
+}
+
+/* Order keysize scores by descending coincidence, then ascending keysize. */
+static int
+keysize_coincidence_compare(const void *a, const void *b)
+{
+  const keysize_score_t * const score_a = a;
+  const keysize_score_t * const score_b = b;
+
+  if (score_a->coincidence > score_b->coincidence) {
+    return -1;
+  } else if (score_a->coincidence < score_b->coincidence) {
+    return 1;
+  } else if (score_a->keysize < score_b->keysize) {
+    return -1;
+  } else if (score_a->keysize > score_b->keysize) {
+    return 1;
+  }
+
+  return 0;
+}
+
+/* Sort count scores from best (highest coincidence) to worst.
+ * Ties are broken by preferring the shorter keysize, because multiples of
+ * the real keysize have the same expected coincidence. */
+void
+keysize_sort_coincidence(keysize_score_t *scores, size_t count)
+{
+  assert(scores != NULL || count == 0);
+
+  if (count > 1) {
+    qsort(scores, count, sizeof(*scores), &keysize_coincidence_compare);
+  }
+}
+
+/* Compare the block pairs for state index that start in the current chunk.
+ * Each keysize only touches its own state, so keysizes can run in
+ * parallel. */
+static void
+keysize_chunk_task(size_t index, size_t thread_index, void *context)
+{
+  (void)thread_index;
+
+  const keysize_chunk_job_t * const job = context;
+  assert(job != NULL);
+  keysize_state_t * const state = &job->states[index];
+  const size_t keysize = state->keysize;
+  assert(keysize > 0);
+
+  while (state->next_block * keysize < job->chunk_end
+         && (state->next_block + 2) * keysize <= job->length
+         && (job->max_pairs == 0 || state->pair_count < job->max_pairs)) {
+    const uint8_t *block = &job->bytes[state->next_block * keysize];
+
+    state->bit_total += hamming_bytes(block, block + keysize, keysize);
+    state->pair_count++;
+    state->next_block++;
+  }
+}
+
+/* Convert state into a score. Keysizes without any pairs have the worst
+ * possible distance. */
+static keysize_score_t
+keysize_state_to_score(const keysize_state_t *state)
+{
+  assert(state != NULL);
+
+  keysize_score_t score;
+  score.keysize = state->keysize;
+  score.coincidence = 0.0;
+  score.pair_count = state->pair_count;
+
+  if (state->pair_count > 0) {
+    score.distance = ((double)state->bit_total
+                      / (double)(state->pair_count * state->keysize));
+    assert(score.distance >= 0.0);
+    assert(score.distance <= BYTE_BIT);
+  } else {
+    score.distance = DBL_MAX;
+  }
+
+  return score;
+}
+
+/* Rank the keysizes from options->min_keysize to options->max_keysize by the
+ * mean normalised hamming distance between adjacent blocks in ciphertext.
+ * The ciphertext is swept one chunk at a time. In each chunk, the keysizes
+ * are compared in parallel, on a pool of workers that is started once per
+ * ranking. Comparisons stop early once the ranking settles (see
+ * keysize_options_t).
+ * Writes up to scores_out_count scores to scores_out, best first, and returns
+ * the number written. Keysizes without a full pair of blocks in ciphertext
+ * are skipped.
+ * If options is NULL, uses the defaults from keysize_options_init(). */
+size_t
+keysize_rank_hamming(const bytearray_t *ciphertext,
+                     const keysize_options_t *options,
+                     keysize_score_t *scores_out, size_t scores_out_count)
+{
+  assert(ciphertext != NULL);
+  assert(is_bytearray_consistent(ciphertext));
+  assert(scores_out != NULL || scores_out_count == 0);
+
+  keysize_options_t default_options;
+  if (options == NULL) {
+    keysize_options_init(&default_options);
+    options = &default_options;
+  }
+
+  assert(options->min_keysize > 0);
+  assert(options->min_keysize <= options->max_keysize);
+
+  const size_t length = bytearray_length(ciphertext);
+
+  /* Only keysizes with at least one pair of blocks */
+  size_t max_keysize = options->max_keysize;
+  if (max_keysize > length / 2) {
+    max_keysize = length / 2;
+  }
+  if (max_keysize < options->min_keysize) {
+    return 0;
+  }
+
+  const size_t keysize_count = max_keysize - options->min_keysize + 1;
+  keysize_state_t * const states = calloc(keysize_count, sizeof(*states));
+  keysize_score_t * const ranking = calloc(keysize_count, sizeof(*ranking));
+  assert(states != NULL);
+  assert(ranking != NULL);
+
+  for (size_t i = 0; i < keysize_count; i++) {
+    states[i].keysize = options->min_keysize + i;
+  }
+
+  size_t stable_top = options->stable_top;
+  if (stable_top > keysize_count) {
+    stable_top = keysize_count;
+  }
+  /* Keysizes are never 0, so the first chunk always changes the ranking */
+  size_t * const previous_top = calloc(keysize_count, sizeof(*previous_top));
+  assert(previous_top != NULL);
+  size_t stable_chunk_count = 0;
+
+  /* The same workers compare every chunk */
+  parallel_pool_t *pool = parallel_pool_alloc(options->thread_count);
+
+  keysize_chunk_job_t job;
+  job.bytes = bytearray_const_pointer_checked(ciphertext, 0, length);
+  job.length = length;
+  job.chunk_end = 0;
+  job.max_pairs = options->max_pairs;
+  job.states = states;
+
+  while (job.chunk_end < length) {
+    job.chunk_end += KEYSIZE_CHUNK_BYTES;
+    if (job.chunk_end > length) {
+      job.chunk_end = length;
+    }
+
+    parallel_pool_for(pool, keysize_count, &keysize_chunk_task, &job);
+
+    if (options->stable_chunks == 0 || stable_top == 0) {
+      continue;
+    }
+
+    /* Has the ranking settled? */
+    for (size_t i = 0; i < keysize_count; i++) {
+      ranking[i] = keysize_state_to_score(&states[i]);
+    }
+    keysize_sort_scores(ranking, keysize_count);
+
+    bool top_changed = false;
+    for (size_t i = 0; i < stable_top; i++) {
+      if (previous_top[i] != ranking[i].keysize) {
+        top_changed = true;
+        previous_top[i] = ranking[i].keysize;
+      }
+    }
+
+    stable_chunk_count = (top_changed ? 0 : stable_chunk_count + 1);
+    if (stable_chunk_count >= options->stable_chunks) {
+      break;
+    }
+  }
+
+  for (size_t i = 0; i < keysize_count; i++) {
+    ranking[i] = keysize_state_to_score(&states[i]);
+    assert(ranking[i].pair_count > 0);
+  }
+  keysize_sort_scores(ranking, keysize_count);
+
+  const size_t result = (keysize_count < scores_out_count
+                         ? keysize_count
+                         : scores_out_count);
+  if (result > 0) {
+    memcpy(scores_out, ranking, result * sizeof(*scores_out));
+  }
+
+  parallel_pool_free(pool);
+  free(states);
+  free(ranking);
+  free(previous_top);
+
+  return result;
+}
+
+/* Index of Coincidence */
+
+/* Return the number of pairs in count items. */
+static size_t
+count_pairs(size_t count)
+{
+  return (count > 0 ? count * (count - 1) / 2 : 0);
+}
+
+/* Find the index of coincidence for score index in the
+ * keysize_coincidence_job_t context, using its keysize.
+ * Makes a single strided pass over a sample of the ciphertext, counting
+ * each byte in its column's histogram. Each byte is equal to every byte
+ * already counted with the same value in its column, so the equal pairs
+ * are summed as the bytes are counted.
+ * A parallel_task_func. */
+static void
+keysize_coincidence_task(size_t index, size_t thread_index, void *context)
+{
+  const keysize_coincidence_job_t * const job = context;
+  assert(job != NULL);
+
+  keysize_score_t * const score = &job->scores[index];
+  const size_t keysize = score->keysize;
+  assert(keysize > 0);
+  assert(keysize <= job->max_keysize);
+
+  if (job->column_counts[thread_index] == NULL) {
+    job->column_counts[thread_index] = calloc(job->max_keysize
+                                              * BYTE_VALUE_COUNT,
+                                              sizeof(uint16_t));
+    assert(job->column_counts[thread_index] != NULL);
+  }
+
+  uint16_t * const counts = job->column_counts[thread_index];
+  memset(counts, 0, keysize * BYTE_VALUE_COUNT * sizeof(*counts));
+
+  size_t sample_length = keysize * KEYSIZE_COINCIDENCE_COLUMN_BYTES;
+  if (sample_length > job->length) {
+    sample_length = job->length;
+  }
+
+  size_t equal_pairs = 0;
+  uint16_t *column_counts = counts;
+  uint16_t * const counts_end = counts + keysize * BYTE_VALUE_COUNT;
+
+  for (size_t i = 0; i < sample_length; i++) {
+    uint16_t * const count = &column_counts[job->bytes[i]];
+    equal_pairs += *count;
+    (*count)++;
+
+    column_counts += BYTE_VALUE_COUNT;
+    if (column_counts == counts_end) {
+      column_counts = counts;
+    }
+  }
+
+  /* The first sample_length % keysize columns have one more byte */
+  const size_t column_length = sample_length / keysize;
+  const size_t long_columns = sample_length % keysize;
+  const size_t pairs = (long_columns * count_pairs(column_length + 1)
+                        + (keysize - long_columns)
+                        * count_pairs(column_length));
+
+  score->distance = 0.0;
+  score->pair_count = pairs;
+  score->coincidence = (pairs > 0 ? (double)equal_pairs / (double)pairs : 0.0);
+  assert(score->coincidence >= 0.0);
+  assert(score->coincidence <= 1.0);
+}
+
+/* Rank the keysizes from options->min_keysize to options->max_keysize by the
+ * index of coincidence of their columns in ciphertext: the probability that
+ * two bytes encrypted with the same key byte are equal. Plaintext bytes are
+ * unevenly distributed, so the columns of the real keysize (and its
+ * multiples) have a much higher coincidence than other keysizes.
+ * Each keysize counts at most KEYSIZE_COINCIDENCE_COLUMN_BYTES bytes in
+ * each column, so long keysizes take as little time as short ones. The
+ * keysizes are counted in parallel.
+ * Writes up to scores_out_count scores to scores_out, best first, and returns
+ * the number written. Keysizes without two bytes in every column are
+ * skipped.
+ * If options is NULL, uses the defaults from keysize_options_init(). */
+size_t
+keysize_rank_coincidence(const bytearray_t *ciphertext,
+                         const keysize_options_t *options,
+                         keysize_score_t *scores_out,
+                         size_t scores_out_count)
+{
+  assert(ciphertext != NULL);
+  assert(is_bytearray_consistent(ciphertext));
+  assert(scores_out != NULL || scores_out_count == 0);
+
+  keysize_options_t default_options;
+  if (options == NULL) {
+    keysize_options_init(&default_options);
+    options = &default_options;
+  }
+
+  assert(options->min_keysize > 0);
+  assert(options->min_keysize <= options->max_keysize);
+
+  const size_t length = bytearray_length(ciphertext);
+
+  /* Only keysizes with at least one pair of bytes in every column */
+  size_t max_keysize = options->max_keysize;
+  if (max_keysize > length / 2) {
+    max_keysize = length / 2;
+  }
+  if (max_keysize < options->min_keysize) {
+    return 0;
+  }
+
+  const size_t keysize_count = max_keysize - options->min_keysize + 1;
+  keysize_score_t * const ranking = calloc(keysize_count, sizeof(*ranking));
+  assert(ranking != NULL);
+
+  for (size_t i = 0; i < keysize_count; i++) {
+    ranking[i].keysize = options->min_keysize + i;
+  }
+
+  const size_t threads = parallel_thread_count(options->thread_count);
+  uint16_t ** const column_counts = calloc(threads, sizeof(*column_counts));
+  assert(column_counts != NULL);
+
+  keysize_coincidence_job_t job;
+  job.bytes = bytearray_const_pointer_checked(ciphertext, 0, length);
+  job.length = length;
+  job.max_keysize = max_keysize;
+  job.scores = ranking;
+  job.column_counts = column_counts;
+
+  parallel_for(keysize_count, threads, &keysize_coincidence_task, &job);
+
+  keysize_sort_coincidence(ranking, keysize_count);
+
+  const size_t result = (keysize_count < scores_out_count
+                         ? keysize_count
+                         : scores_out_count);
+  if (result > 0) {
+    memcpy(scores_out, ranking, result * sizeof(*scores_out));
+  }
+
+  for (size_t i = 0; i < threads; i++) {
+    free(column_counts[i]);
+  }
+  free(column_counts);
+  free(ranking);
+
+  return result;
+}
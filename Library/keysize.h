@@ -0,0 +1,97 @@
+//
+//  keysize.h
+//  MatasanoCrypto
+//
+//  Created by Tim Wilson-Brown on 18/10/2026.
+//  Copyright © 2026 teor - gmail: teor2345
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef keysize_h
+#define keysize_h
+
+#include <sys/types.h>
+
+/* Forward Declarations */
+
+typedef struct bytearray_t bytearray_t;
+
+/* Keysize Constants */
+
+/* The keysize range suggested by the repeating-key XOR challenge */
+#define KEYSIZE_MIN_DEFAULT 2
+#define KEYSIZE_MAX_DEFAULT 40
+
+/* Block pairs are compared a chunk of ciphertext at a time, so every
+ * keysize works on the same cache-resident bytes. */
+#define KEYSIZE_CHUNK_BYTES (32*1024)
+
+/* The index of coincidence only needs a sample of each column, so at most
+ * this many bytes are counted in each column. Column counts are 16 bits, so
+ * this must be at most UINT16_MAX. */
+#define KEYSIZE_COINCIDENCE_COLUMN_BYTES 256
+
+/* Data Types */
+
+/* The score for a single keysize. Lower distances are better. */
+typedef struct keysize_score_t {
+  size_t keysize;
+  /* The mean hamming distance between adjacent keysize blocks, in bits per
+   * byte. English XORed with English is around 2-3 bits per byte, random
+   * data is around 4. */
+  double distance;
+  /* The probability that two bytes in the same keysize column are equal.
+   * English XORed with a repeating key is around 0.06-0.07, random data is
+   * around 1/256. Only set by keysize_rank_coincidence(), otherwise 0.0. */
+  double coincidence;
+  /* The number of block pairs compared, or the number of byte pairs in the
+   * same column for keysize_rank_coincidence() */
+  size_t pair_count;
+} keysize_score_t;
+
+/* The options for keysize_rank_hamming(). Use keysize_options_init() to set
+ * the defaults. keysize_rank_coincidence() only uses the keysize range and
+ * thread count. */
+typedef struct keysize_options_t {
+  size_t min_keysize;
+  size_t max_keysize;
+  /* The maximum number of block pairs compared for each keysize.
+   * 0 compares every pair in the ciphertext. */
+  size_t max_pairs;
+  /* Stop early when the best stable_top keysizes have been in the same order
+   * for stable_chunks consecutive chunks. 0 disables stopping early. */
+  size_t stable_chunks;
+  size_t stable_top;
+  /* See parallel_thread_count() */
+  size_t thread_count;
+} keysize_options_t;
+
+/* Function Declarations */
+
+void keysize_options_init(keysize_options_t *options);
+
+void keysize_sort_scores(keysize_score_t *scores, size_t count);
+void keysize_sort_coincidence(keysize_score_t *scores, size_t count);
+
+size_t keysize_rank_hamming(const bytearray_t *ciphertext,
+                            const keysize_options_t *options,
+                            keysize_score_t *scores_out,
+                            size_t scores_out_count);
+size_t keysize_rank_coincidence(const bytearray_t *ciphertext,
+                                const keysize_options_t *options,
+                                keysize_score_t *scores_out,
+                                size_t scores_out_count);
+
+#endif /* keysize_h */
@@ -0,0 +1,322 @@
+//
+//  model.c
+//  MatasanoCrypto
+//
+//  Created by Tim Wilson-Brown on 18/10/2026.
+//  Copyright © 2026 teor - gmail: teor2345
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "model.h"
+
+#include <assert.h>
+
+/* Byte Tables
+ * Each table is the log2 probability of each byte in a kind of text,
+ * multiplied by SCORE_MODEL_BIT_SCALE and rounded. Every byte that isn't
+ * expected in the text has a floor probability of 2^-20.
+ * The tables are precomputed, so scoring is a sum of table lookups. */
+
+/* The log2 probability of each byte in English text, multiplied by
+ * SCORE_MODEL_BIT_SCALE and rounded.
+ * The byte probabilities are built from the constants used by the heuristic
+ * model in score.c: english_letter_frequency, one space every
+ * ENGLISH_SPACE_LENGTH characters, punctuation every
+ * ENGLISH_PUNCTUATION_LENGTH words, and a newline every ENGLISH_LINE_LENGTH
+ * characters. 4% of letters are uppercase, 0.5% of characters are digits,
+ * and every other byte has the floor probability. The entropy of this
+ * distribution is 4.6 bits per byte.
+ *
+ * Ranking quality, compared with score_english_text():
+ * - The challenge 3 ciphertext in s1c3-xor-cipher.c: both models rank the
+ *   correct key first.
+ * - 4.txt: both models rank the correct line and key first, out of 83,712
+ *   candidates. The log-likelihood runner up is 1.9 bits per byte behind,
+ *   but the heuristic scores every other candidate 0.0.
+ * - 6.txt, keysize 29: the log-likelihood model ranks the correct key first
+ *   in all 29 columns, the heuristic in 27 columns. The heuristic scores
+ *   every key 0.0 in the other 2 columns, so it can't rank them.
+ * The heuristic model has a natural threshold, but the log-likelihood model
+ * ranks every candidate, so it is better at choosing the best of many. */
+static const int16_t english_log_likelihood[BYTE_VALUE_COUNT] = {
+  /* 0x00 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -2807, -1362, -5120, -5120, -2807, -5120, -5120,
+  /* 0x10 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+  /* 0x20 */ -662, -2535, -2173, -3420, -3420, -3420, -3420, -2090,
+             -2941, -2941, -3420, -3420, -1685, -2222, -1685, -3420,
+  /* 0x30 */ -2807, -2807, -2807, -2807, -2807, -2807, -2807, -2807,
+             -2807, -2807, -2535, -2535, -3420, -3420, -3420, -2429,
+  /* 0x40 */ -3420, -2213, -2841, -2611, -2454, -2050, -2693, -2730,
+             -2321, -2272, -3682, -3084, -2474, -2664, -2283, -2244,
+  /* 0x50 */ -2746, -3858, -2327, -2307, -2175, -2614, -2997, -2671,
+             -3689, -2737, -3950, -3420, -3420, -3420, -3420, -3420,
+  /* 0x60 */ -3420, -1039, -1667, -1437, -1280, -876, -1519, -1556,
+             -1147, -1098, -2508, -1910, -1300, -1490, -1109, -1070,
+  /* 0x70 */ -1572, -2684, -1154, -1133, -1001, -1440, -1823, -1497,
+             -2515, -1564, -2776, -3420, -3420, -3420, -3420, -5120,
+  /* 0x80 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+  /* 0x90 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+  /* 0xa0 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+  /* 0xb0 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+  /* 0xc0 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+  /* 0xd0 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+  /* 0xe0 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+  /* 0xf0 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+};
+
+/* The other languages are built like the English table, using their letter
+ * frequencies from https://en.wikipedia.org/wiki/Letter_frequency, with
+ * accents removed. Accented letters are counted as UTF-8: 1.5% of French
+ * bytes, and 1% of German and Spanish bytes, are split evenly between 0xc3
+ * lead bytes and 0x80-0xbf continuation bytes.
+ * German has one space every 7 characters, and 8% of its letters are
+ * uppercase. The entropy of each distribution is around 4.6 bits per byte.
+ */
+static const int16_t french_log_likelihood[BYTE_VALUE_COUNT] = {
+  /* 0x00 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -2807, -1362, -5120, -5120, -2807, -5120, -5120,
+  /* 0x10 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+  /* 0x20 */ -662, -2535, -2173, -3420, -3420, -3420, -3420, -2090,
+             -2941, -2941, -3420, -3420, -1685, -2222, -1685, -3420,
+  /* 0x30 */ -2807, -2807, -2807, -2807, -2807, -2807, -2807, -2807,
+             -2807, -2807, -2535, -2535, -3420, -3420, -3420, -2429,
+  /* 0x40 */ -3420, -2341, -3130, -2655, -2611, -2098, -3068, -3145,
+             -3204, -2346, -3272, -4053, -2465, -2690, -2368, -2443,
+  /* 0x50 */ -2750, -2977, -2389, -2326, -2360, -2411, -2867, -4205,
+             -3406, -3851, -3506, -3420, -3420, -3420, -3420, -3420,
+  /* 0x60 */ -3420, -1057, -1846, -1371, -1328, -815, -1784, -1861,
+             -1920, -1062, -1988, -2769, -1181, -1406, -1084, -1159,
+  /* 0x70 */ -1466, -1694, -1106, -1042, -1076, -1127, -1583, -2922,
+             -2122, -2567, -2222, -3420, -3420, -3420, -3420, -5120,
+  /* 0x80 */ -3343, -3343, -3343, -3343, -3343, -3343, -3343, -3343,
+             -3343, -3343, -3343, -3343, -3343, -3343, -3343, -3343,
+  /* 0x90 */ -3343, -3343, -3343, -3343, -3343, -3343, -3343, -3343,
+             -3343, -3343, -3343, -3343, -3343, -3343, -3343, -3343,
+  /* 0xa0 */ -3343, -3343, -3343, -3343, -3343, -3343, -3343, -3343,
+             -3343, -3343, -3343, -3343, -3343, -3343, -3343, -3343,
+  /* 0xb0 */ -3343, -3343, -3343, -3343, -3343, -3343, -3343, -3343,
+             -3343, -3343, -3343, -3343, -3343, -3343, -3343, -3343,
+  /* 0xc0 */ -5120, -5120, -5120, -1807, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+  /* 0xd0 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+  /* 0xe0 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+  /* 0xf0 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+};
+
+static const int16_t german_log_likelihood[BYTE_VALUE_COUNT] = {
+  /* 0x00 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -2807, -1362, -5120, -5120, -2807, -5120, -5120,
+  /* 0x10 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+  /* 0x20 */ -719, -2592, -2230, -3420, -3420, -3420, -3420, -2147,
+             -2998, -2998, -3420, -3420, -1742, -2279, -1742, -3420,
+  /* 0x30 */ -2807, -2807, -2807, -2807, -2807, -2807, -2807, -2807,
+             -2807, -2807, -2592, -2592, -3420, -3420, -3420, -2486,
+  /* 0x40 */ -3420, -2023, -2480, -2344, -2115, -1682, -2528, -2308,
+             -2153, -2021, -3201, -2586, -2259, -2371, -1873, -2363,
+  /* 0x50 */ -2863, -4199, -1996, -1982, -2044, -2188, -2777, -2474,
+             -3964, -3913, -2668, -3420, -3420, -3420, -3420, -3420,
+  /* 0x60 */ -3420, -1121, -1578, -1442, -1213, -780, -1626, -1406,
+             -1251, -1119, -2299, -1684, -1357, -1469, -971, -1461,
+  /* 0x70 */ -1961, -3296, -1094, -1080, -1142, -1286, -1874, -1572,
+             -3062, -3011, -1766, -3420, -3420, -3420, -3420, -5120,
+  /* 0x80 */ -3493, -3493, -3493, -3493, -3493, -3493, -3493, -3493,
+             -3493, -3493, -3493, -3493, -3493, -3493, -3493, -3493,
+  /* 0x90 */ -3493, -3493, -3493, -3493, -3493, -3493, -3493, -3493,
+             -3493, -3493, -3493, -3493, -3493, -3493, -3493, -3493,
+  /* 0xa0 */ -3493, -3493, -3493, -3493, -3493, -3493, -3493, -3493,
+             -3493, -3493, -3493, -3493, -3493, -3493, -3493, -3493,
+  /* 0xb0 */ -3493, -3493, -3493, -3493, -3493, -3493, -3493, -3493,
+             -3493, -3493, -3493, -3493, -3493, -3493, -3493, -3493,
+  /* 0xc0 */ -5120, -5120, -5120, -1957, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+  /* 0xd0 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+  /* 0xe0 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+  /* 0xf0 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+};
+
+static const int16_t spanish_log_likelihood[BYTE_VALUE_COUNT] = {
+  /* 0x00 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -2807, -1362, -5120, -5120, -2807, -5120, -5120,
+  /* 0x10 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+  /* 0x20 */ -662, -2535, -2173, -3420, -3420, -3420, -3420, -2090,
+             -2941, -2941, -3420, -3420, -1685, -2222, -1685, -3420,
+  /* 0x30 */ -2807, -2807, -2807, -2807, -2807, -2807, -2807, -2807,
+             -2807, -2807, -2535, -2535, -3420, -3420, -3420, -2429,
+  /* 0x40 */ -3420, -2185, -2795, -2575, -2493, -2165, -3224, -2878,
+             -3218, -2412, -3350, -4754, -2496, -2664, -2385, -2290,
+  /* 0x50 */ -2748, -3137, -2377, -2321, -2522, -2692, -3041, -4593,
+             -3656, -3085, -3370, -3420, -3420, -3420, -3420, -3420,
+  /* 0x60 */ -3420, -902, -1511, -1291, -1209, -881, -1940, -1594,
+             -1935, -1128, -2066, -3470, -1213, -1380, -1101, -1006,
+  /* 0x70 */ -1465, -1853, -1093, -1038, -1238, -1408, -1757, -3309,
+             -2372, -1802, -2086, -3420, -3420, -3420, -3420, -5120,
+  /* 0x80 */ -3493, -3493, -3493, -3493, -3493, -3493, -3493, -3493,
+             -3493, -3493, -3493, -3493, -3493, -3493, -3493, -3493,
+  /* 0x90 */ -3493, -3493, -3493, -3493, -3493, -3493, -3493, -3493,
+             -3493, -3493, -3493, -3493, -3493, -3493, -3493, -3493,
+  /* 0xa0 */ -3493, -3493, -3493, -3493, -3493, -3493, -3493, -3493,
+             -3493, -3493, -3493, -3493, -3493, -3493, -3493, -3493,
+  /* 0xb0 */ -3493, -3493, -3493, -3493, -3493, -3493, -3493, -3493,
+             -3493, -3493, -3493, -3493, -3493, -3493, -3493, -3493,
+  /* 0xc0 */ -5120, -5120, -5120, -1957, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+  /* 0xd0 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+  /* 0xe0 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+  /* 0xf0 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+};
+
+/* Base64-encoded data has 64 equally likely characters, one newline every
+ * 77 characters (76-character MIME lines), and a few '=' padding characters.
+ * The entropy of this distribution is 6.0 bits per byte. */
+static const int16_t base64_log_likelihood[BYTE_VALUE_COUNT] = {
+  /* 0x00 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -1604, -5120, -5120, -2551, -5120, -5120,
+  /* 0x10 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+  /* 0x20 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -1543, -5120, -5120, -5120, -1543,
+  /* 0x30 */ -1543, -1543, -1543, -1543, -1543, -1543, -1543, -1543,
+             -1543, -1543, -5120, -5120, -5120, -1957, -5120, -5120,
+  /* 0x40 */ -5120, -1543, -1543, -1543, -1543, -1543, -1543, -1543,
+             -1543, -1543, -1543, -1543, -1543, -1543, -1543, -1543,
+  /* 0x50 */ -1543, -1543, -1543, -1543, -1543, -1543, -1543, -1543,
+             -1543, -1543, -1543, -5120, -5120, -5120, -5120, -5120,
+  /* 0x60 */ -5120, -1543, -1543, -1543, -1543, -1543, -1543, -1543,
+             -1543, -1543, -1543, -1543, -1543, -1543, -1543, -1543,
+  /* 0x70 */ -1543, -1543, -1543, -1543, -1543, -1543, -1543, -1543,
+             -1543, -1543, -1543, -5120, -5120, -5120, -5120, -5120,
+  /* 0x80 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+  /* 0x90 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+  /* 0xa0 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+  /* 0xb0 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+  /* 0xc0 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+  /* 0xd0 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+  /* 0xe0 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+  /* 0xf0 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+};
+
+/* JSON, HTML, and XML markup has English-like letters, and many more quotes,
+ * brackets, and digits. 14% of characters are spaces, including
+ * indentation. The entropy of this distribution is 5.3 bits per byte. */
+static const int16_t markup_log_likelihood[BYTE_VALUE_COUNT] = {
+  /* 0x00 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -1701, -1295, -5120, -5120, -2295, -5120, -5120,
+  /* 0x10 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+  /* 0x20 */ -726, -2551, -1106, -2295, -3181, -3181, -2295, -2145,
+             -2295, -2295, -3181, -3181, -1551, -1889, -1783, -1551,
+  /* 0x30 */ -1957, -1957, -1957, -1957, -1957, -1957, -1957, -1957,
+             -1957, -1957, -1445, -2145, -1445, -1633, -1445, -3181,
+  /* 0x40 */ -3181, -2075, -2703, -2473, -2316, -1912, -2555, -2592,
+             -2183, -2134, -3544, -2946, -2336, -2526, -2145, -2106,
+  /* 0x50 */ -2608, -3720, -2190, -2169, -2037, -2476, -2859, -2533,
+             -3551, -2599, -3812, -2039, -3181, -2039, -3181, -1957,
+  /* 0x60 */ -3181, -1173, -1801, -1571, -1414, -1010, -1653, -1690,
+             -1281, -1232, -2642, -2044, -1434, -1624, -1243, -1204,
+  /* 0x70 */ -1706, -2818, -1288, -1267, -1135, -1574, -1957, -1631,
+             -2649, -1697, -2910, -1783, -3181, -1783, -3181, -5120,
+  /* 0x80 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+  /* 0x90 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+  /* 0xa0 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+  /* 0xb0 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+  /* 0xc0 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+  /* 0xd0 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+  /* 0xe0 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+  /* 0xf0 */ -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+             -5120, -5120, -5120, -5120, -5120, -5120, -5120, -5120,
+};
+
+/* Model Registry */
+
+/* Every model, indexed by score_model_id_t */
+static const score_model_t score_models[SCORE_MODEL_COUNT] = {
+  [SCORE_MODEL_ENGLISH_HEURISTIC] = {
+    SCORE_MODEL_ENGLISH_HEURISTIC, "english-heuristic", NULL
+  },
+  [SCORE_MODEL_ENGLISH_LOG_LIKELIHOOD] = {
+    SCORE_MODEL_ENGLISH_LOG_LIKELIHOOD, "english", english_log_likelihood
+  },
+  [SCORE_MODEL_ENGLISH_NGRAM] = {
+    SCORE_MODEL_ENGLISH_NGRAM, "english-ngram", NULL
+  },
+  [SCORE_MODEL_FRENCH_LOG_LIKELIHOOD] = {
+    SCORE_MODEL_FRENCH_LOG_LIKELIHOOD, "french", french_log_likelihood
+  },
+  [SCORE_MODEL_GERMAN_LOG_LIKELIHOOD] = {
+    SCORE_MODEL_GERMAN_LOG_LIKELIHOOD, "german", german_log_likelihood
+  },
+  [SCORE_MODEL_SPANISH_LOG_LIKELIHOOD] = {
+    SCORE_MODEL_SPANISH_LOG_LIKELIHOOD, "spanish", spanish_log_likelihood
+  },
+  [SCORE_MODEL_BASE64_LOG_LIKELIHOOD] = {
+    SCORE_MODEL_BASE64_LOG_LIKELIHOOD, "base64", base64_log_likelihood
+  },
+  [SCORE_MODEL_MARKUP_LOG_LIKELIHOOD] = {
+    SCORE_MODEL_MARKUP_LOG_LIKELIHOOD, "markup", markup_log_likelihood
+  },
+};
+
+/* Return the model for model. */
+const score_model_t *
+score_model_get(score_model_id_t model)
+{
+  assert(model < SCORE_MODEL_COUNT);
+  assert(score_models[model].id == model);
+
+  return &score_models[model];
+}
+
+/* Is model a byte table model? */
+bool
+is_score_model_byte_table(score_model_id_t model)
+{
+  return score_model_get(model)->byte_log_likelihood != NULL;
+}
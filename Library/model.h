@@ -0,0 +1,57 @@
+//
+//  model.h
+//  MatasanoCrypto
+//
+//  Created by Tim Wilson-Brown on 18/10/2026.
+//  Copyright © 2026 teor - gmail: teor2345
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef model_h
+#define model_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "score.h"
+
+/* Model Constants */
+
+/* Byte log-likelihoods are fixed-point log2 probabilities, with this many
+ * units per bit */
+#define SCORE_MODEL_BIT_SCALE 256
+
+/* Data Types */
+
+/* A text scoring model.
+ * Byte table models score text using the log2 probability of each byte, so
+ * they can all be scored from the same histogram, and their scores can be
+ * compared with each other. Other models have their own scoring code in
+ * score.c. */
+typedef struct score_model_t {
+  score_model_id_t id;
+  const char *name;
+  /* The log2 probability of each byte, multiplied by SCORE_MODEL_BIT_SCALE,
+   * or NULL if the model isn't a byte table */
+  const int16_t *byte_log_likelihood;
+} score_model_t;
+
+/* Function Declarations */
+
+const score_model_t *score_model_get(score_model_id_t model);
+bool is_score_model_byte_table(score_model_id_t model);
+
+#endif /* model_h */
@@ -0,0 +1,470 @@
+//
+//  ngram.c
+//  MatasanoCrypto
+//
+//  Created by Tim Wilson-Brown on 18/10/2026.
+//  Copyright © 2026 teor - gmail: teor2345
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "ngram.h"
+
+#include <assert.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "histogram.h"
+
+/* Byte Classes */
+
+#define NGRAM_CLASS_OTHER 0
+#define NGRAM_CLASS_LETTER_FIRST 1
+#define NGRAM_CLASS_SPACE 27
+#define NGRAM_CLASS_DIGIT 28
+#define NGRAM_CLASS_PUNCTUATION 29
+#define NGRAM_CLASS_WHITESPACE 30
+#define NGRAM_CLASS_PRINTABLE 31
+
+/* Return the trigram class of byte, which is less than NGRAM_CLASS_COUNT.
+ * Letters are case-insensitive. */
+uint8_t
+ngram_byte_class(uint8_t byte)
+{
+  if (byte >= 'a' && byte <= 'z') {
+    return (uint8_t)(NGRAM_CLASS_LETTER_FIRST + (byte - 'a'));
+  } else if (byte >= 'A' && byte <= 'Z') {
+    return (uint8_t)(NGRAM_CLASS_LETTER_FIRST + (byte - 'A'));
+  } else if (byte == ' ') {
+    return NGRAM_CLASS_SPACE;
+  } else if (byte >= '0' && byte <= '9') {
+    return NGRAM_CLASS_DIGIT;
+  } else if (byte != 0 && strchr(".,!?;:", byte) != NULL) {
+    return NGRAM_CLASS_PUNCTUATION;
+  } else if (byte == '\t' || byte == '\n' || byte == '\r') {
+    return NGRAM_CLASS_WHITESPACE;
+  } else if (byte > ' ' && byte <= '~') {
+    return NGRAM_CLASS_PRINTABLE;
+  } else {
+    return NGRAM_CLASS_OTHER;
+  }
+}
+
+/* Return the index of the bigram (previous, byte). */
+static size_t
+bigram_index(uint8_t previous, uint8_t byte)
+{
+  return (size_t)previous * BYTE_VALUE_COUNT + byte;
+}
+
+/* Return the index of the trigram of classes (class1, class2, class3). */
+static size_t
+trigram_index(uint8_t class1, uint8_t class2, uint8_t class3)
+{
+  assert(class1 < NGRAM_CLASS_COUNT);
+  assert(class2 < NGRAM_CLASS_COUNT);
+  assert(class3 < NGRAM_CLASS_COUNT);
+
+  return ((size_t)class1 * NGRAM_CLASS_COUNT + class2) * NGRAM_CLASS_COUNT
+         + class3;
+}
+
+/* Training */
+
+/* Allocate and return a new ngram_counts_t with every count zero.
+ * The caller must free the counts using ngram_counts_free(). */
+ngram_counts_t *
+ngram_counts_alloc(void)
+{
+  ngram_counts_t *counts = calloc(1, sizeof(*counts));
+  assert(counts != NULL);
+
+  return counts;
+}
+
+/* Free counts, which was allocated by ngram_counts_alloc(). */
+void
+ngram_counts_free(ngram_counts_t *counts)
+{
+  free(counts);
+}
+
+/* Count the n-grams in the length bytes at bytes, and add them to counts.
+ * Each call is counted as a separate text: n-grams don't span calls. */
+void
+ngram_counts_add_text(ngram_counts_t *counts, const uint8_t *bytes,
+                      size_t length)
+{
+  assert(counts != NULL);
+  assert(bytes != NULL || length == 0);
+
+  for (size_t i = 0; i < length; i++) {
+    counts->unigram[bytes[i]]++;
+
+    if (i >= 1) {
+      counts->bigram[bigram_index(bytes[i - 1], bytes[i])]++;
+    }
+
+    if (i >= 2) {
+      counts->trigram[trigram_index(ngram_byte_class(bytes[i - 2]),
+                                    ngram_byte_class(bytes[i - 1]),
+                                    ngram_byte_class(bytes[i]))]++;
+    }
+  }
+
+  counts->length += length;
+}
+
+/* Return the fixed-point log2 probability of count out of total, using
+ * add-one smoothing over outcome_count possible outcomes. */
+static int16_t
+smoothed_log_probability(uint64_t count, uint64_t total,
+                         size_t outcome_count)
+{
+  const double probability = ((double)count + 1.0)
+                             / ((double)total + (double)outcome_count);
+  const double scaled = round(log2(probability) * NGRAM_BIT_SCALE);
+
+  assert(scaled <= 0.0);
+
+  if (scaled < INT16_MIN) {
+    return INT16_MIN;
+  }
+
+  return (int16_t)scaled;
+}
+
+/* Convert counts into a model, and write it to the file at path.
+ * Returns true on success, and false if the file can't be written. */
+bool
+ngram_model_write(const ngram_counts_t *counts, const char *path)
+{
+  assert(counts != NULL);
+  assert(path != NULL);
+
+  ngram_model_header_t header;
+  memset(&header, 0, sizeof(header));
+
+  memcpy(header.magic, NGRAM_MODEL_MAGIC, sizeof(NGRAM_MODEL_MAGIC));
+  header.version = NGRAM_MODEL_VERSION;
+  header.byte_order = NGRAM_MODEL_BYTE_ORDER;
+  header.header_length = sizeof(header);
+  header.bit_scale = NGRAM_BIT_SCALE;
+  header.class_count = NGRAM_CLASS_COUNT;
+  header.corpus_length = counts->length;
+  header.class_map_offset = sizeof(header);
+  header.unigram_offset = header.class_map_offset + BYTE_VALUE_COUNT;
+  header.bigram_offset = (header.unigram_offset
+                          + BYTE_VALUE_COUNT * sizeof(int16_t));
+  header.trigram_offset = (header.bigram_offset
+                           + NGRAM_BIGRAM_COUNT * sizeof(int16_t));
+  header.file_length = (header.trigram_offset
+                        + NGRAM_TRIGRAM_COUNT * sizeof(int16_t));
+
+  uint8_t class_map[BYTE_VALUE_COUNT];
+  int16_t unigram[BYTE_VALUE_COUNT];
+  for (size_t b = 0; b < BYTE_VALUE_COUNT; b++) {
+    class_map[b] = ngram_byte_class((uint8_t)b);
+    unigram[b] = smoothed_log_probability(counts->unigram[b], counts->length,
+                                          BYTE_VALUE_COUNT);
+  }
+
+  int16_t *bigram = calloc(NGRAM_BIGRAM_COUNT, sizeof(*bigram));
+  int16_t *trigram = calloc(NGRAM_TRIGRAM_COUNT, sizeof(*trigram));
+  assert(bigram != NULL);
+  assert(trigram != NULL);
+
+  /* Each conditional probability is relative to its context's total */
+  for (size_t previous = 0; previous < BYTE_VALUE_COUNT; previous++) {
+    const uint64_t *row = &counts->bigram[previous * BYTE_VALUE_COUNT];
+    uint64_t row_total = 0;
+    for (size_t b = 0; b < BYTE_VALUE_COUNT; b++) {
+      row_total += row[b];
+    }
+    for (size_t b = 0; b < BYTE_VALUE_COUNT; b++) {
+      bigram[previous * BYTE_VALUE_COUNT + b] = smoothed_log_probability(
+                                                    row[b], row_total,
+                                                    BYTE_VALUE_COUNT);
+    }
+  }
+
+  for (size_t context = 0; context < NGRAM_CLASS_COUNT * NGRAM_CLASS_COUNT;
+       context++) {
+    const uint64_t *row = &counts->trigram[context * NGRAM_CLASS_COUNT];
+    uint64_t row_total = 0;
+    for (size_t c = 0; c < NGRAM_CLASS_COUNT; c++) {
+      row_total += row[c];
+    }
+    for (size_t c = 0; c < NGRAM_CLASS_COUNT; c++) {
+      trigram[context * NGRAM_CLASS_COUNT + c] = smoothed_log_probability(
+                                                      row[c], row_total,
+                                                      NGRAM_CLASS_COUNT);
+    }
+  }
+
+  bool success = false;
+  FILE *f = fopen(path, "wb");
+
+  if (f != NULL) {
+    success = (fwrite(&header, sizeof(header), 1, f) == 1
+               && fwrite(class_map, sizeof(class_map), 1, f) == 1
+               && fwrite(unigram, sizeof(unigram), 1, f) == 1
+               && fwrite(bigram, sizeof(*bigram), NGRAM_BIGRAM_COUNT, f)
+                  == NGRAM_BIGRAM_COUNT
+               && fwrite(trigram, sizeof(*trigram), NGRAM_TRIGRAM_COUNT, f)
+                  == NGRAM_TRIGRAM_COUNT);
+    success = (fclose(f) == 0) && success;
+  }
+
+  free(bigram);
+  free(trigram);
+
+  return success;
+}
+
+/* Loading */
+
+/* Is the table of count entries of entry_size at offset inside a mapping of
+ * mapping_length, and aligned to entry_size? */
+static bool
+is_table_valid(uint64_t offset, size_t count, size_t entry_size,
+               size_t mapping_length)
+{
+  return (offset % entry_size == 0
+          && offset <= mapping_length
+          && count <= (mapping_length - offset) / entry_size);
+}
+
+/* Is every class in the class map at class_map a valid trigram class?
+ * The classes index the trigram table, so a corrupt map would read outside
+ * it. */
+static bool
+is_class_map_valid(const uint8_t class_map[BYTE_VALUE_COUNT])
+{
+  for (size_t b = 0; b < BYTE_VALUE_COUNT; b++) {
+    if (class_map[b] >= NGRAM_CLASS_COUNT) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/* Is every entry in the count log2 probabilities at table at most zero?
+ * Scoring relies on sums of log2 probabilities never being positive. */
+static bool
+is_log_table_valid(const int16_t *table, size_t count)
+{
+  for (size_t i = 0; i < count; i++) {
+    if (table[i] > 0) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/* Is the header at the start of a mapping of mapping_length a valid header
+ * for a model this code can read? Also checks the class map and the signs
+ * of the tables, because the loaded model uses them without any further
+ * checks. */
+static bool
+is_header_valid(const ngram_model_header_t *header, size_t mapping_length)
+{
+  const uint8_t * const base = (const uint8_t *)header;
+
+  return (mapping_length >= sizeof(*header)
+          && memcmp(header->magic, NGRAM_MODEL_MAGIC,
+                    sizeof(NGRAM_MODEL_MAGIC)) == 0
+          && header->version == NGRAM_MODEL_VERSION
+          && header->byte_order == NGRAM_MODEL_BYTE_ORDER
+          && header->header_length == sizeof(*header)
+          && header->bit_scale == NGRAM_BIT_SCALE
+          && header->class_count == NGRAM_CLASS_COUNT
+          && header->file_length == mapping_length
+          && is_table_valid(header->class_map_offset, BYTE_VALUE_COUNT,
+                            sizeof(uint8_t), mapping_length)
+          && is_class_map_valid(base + header->class_map_offset)
+          && is_table_valid(header->unigram_offset, BYTE_VALUE_COUNT,
+                            sizeof(int16_t), mapping_length)
+          && is_log_table_valid((const int16_t *)(base
+                                                  + header->unigram_offset),
+                                BYTE_VALUE_COUNT)
+          && is_table_valid(header->bigram_offset, NGRAM_BIGRAM_COUNT,
+                            sizeof(int16_t), mapping_length)
+          && is_log_table_valid((const int16_t *)(base
+                                                  + header->bigram_offset),
+                                NGRAM_BIGRAM_COUNT)
+          && is_table_valid(header->trigram_offset, NGRAM_TRIGRAM_COUNT,
+                            sizeof(int16_t), mapping_length)
+          && is_log_table_valid((const int16_t *)(base
+                                                  + header->trigram_offset),
+                                NGRAM_TRIGRAM_COUNT));
+}
+
+/* Map the model file at path into memory, and return a newly allocated
+ * ngram_model_t that refers to it. The tables are used in place, so there
+ * is no parsing.
+ * Returns NULL if the file can't be mapped, or isn't a valid model.
+ * The caller must free the model using ngram_model_free(). */
+ngram_model_t *
+ngram_model_load(const char *path)
+{
+  assert(path != NULL);
+
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return NULL;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+    close(fd);
+    return NULL;
+  }
+
+  const size_t mapping_length = (size_t)st.st_size;
+  void *mapping = mmap(NULL, mapping_length, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+
+  if (mapping == MAP_FAILED) {
+    return NULL;
+  }
+
+  const ngram_model_header_t *header = mapping;
+  if (!is_header_valid(header, mapping_length)) {
+    munmap(mapping, mapping_length);
+    return NULL;
+  }
+
+  ngram_model_t *model = malloc(sizeof(*model));
+  assert(model != NULL);
+
+  const uint8_t *base = mapping;
+  model->mapping = mapping;
+  model->mapping_length = mapping_length;
+  model->header = header;
+  model->class_map = base + header->class_map_offset;
+  model->unigram = (const int16_t *)(base + header->unigram_offset);
+  model->bigram = (const int16_t *)(base + header->bigram_offset);
+  model->trigram = (const int16_t *)(base + header->trigram_offset);
+
+  return model;
+}
+
+/* Unmap and free model, which was loaded by ngram_model_load(). */
+void
+ngram_model_free(ngram_model_t *model)
+{
+  if (model == NULL) {
+    return;
+  }
+
+  int rv = munmap(model->mapping, model->mapping_length);
+  assert(rv == 0);
+
+  free(model);
+}
+
+/* Scoring */
+
+/* Return the number of log-probability terms in the score for length
+ * bytes: one byte term per byte, and one class trigram term per byte after
+ * the first two. */
+static size_t
+ngram_term_count(size_t length)
+{
+  return length + (length > 2 ? length - 2 : 0);
+}
+
+/* Return the fixed-point log-likelihood of the length bytes at bytes, using
+ * model. Larger (less negative) values are more likely.
+ * This is the sum of:
+ * - the unigram log-probability of the first byte,
+ * - the bigram log-probability of each byte after that, and
+ * - the class trigram log-probability of each byte after the first two. */
+int64_t
+ngram_model_log_likelihood_sum(const ngram_model_t *model,
+                               const uint8_t *bytes, size_t length)
+{
+  assert(model != NULL);
+  assert(bytes != NULL || length == 0);
+
+  if (length == 0) {
+    return 0;
+  }
+
+  int64_t sum = model->unigram[bytes[0]];
+
+  for (size_t i = 1; i < length; i++) {
+    sum += model->bigram[bigram_index(bytes[i - 1], bytes[i])];
+  }
+
+  for (size_t i = 2; i < length; i++) {
+    sum += model->trigram[trigram_index(model->class_map[bytes[i - 2]],
+                                        model->class_map[bytes[i - 1]],
+                                        model->class_map[bytes[i]])];
+  }
+
+  assert(sum <= 0);
+
+  return sum;
+}
+
+/* How likely is it that the length bytes at bytes are English text?
+ * Returns the mean log2 probability of each n-gram term, which is at most
+ * 0.0. Higher scores are better.
+ * length must not be zero. */
+double
+ngram_model_score_bytes(const ngram_model_t *model, const uint8_t *bytes,
+                        size_t length)
+{
+  assert(model != NULL);
+  assert(length > 0);
+
+  const int64_t sum = ngram_model_log_likelihood_sum(model, bytes, length);
+
+  return ((double)sum
+          / ((double)ngram_term_count(length) * NGRAM_BIT_SCALE));
+}
+
+/* How likely is it that the text counted in histogram, XORed with key, is
+ * English text?
+ * Histograms don't record byte order, so this only uses the unigram table.
+ * Returns the mean log2 probability of each byte, which is at most 0.0.
+ * histogram must not be empty. */
+double
+ngram_model_score_histogram(const ngram_model_t *model,
+                            const byte_histogram_t *histogram, uint8_t key)
+{
+  assert(model != NULL);
+  assert(histogram != NULL);
+  assert(histogram->length > 0);
+
+  int64_t sum = 0;
+
+  for (size_t b = 0; b < BYTE_VALUE_COUNT; b++) {
+    sum += (int64_t)histogram->counts[b] * model->unigram[b ^ key];
+  }
+
+  assert(sum <= 0);
+
+  return ((double)sum / ((double)histogram->length * NGRAM_BIT_SCALE));
+}
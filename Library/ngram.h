@@ -0,0 +1,132 @@
+//
+//  ngram.h
+//  MatasanoCrypto
+//
+//  Created by Tim Wilson-Brown on 18/10/2026.
+//  Copyright © 2026 teor - gmail: teor2345
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef ngram_h
+#define ngram_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "char.h"
+
+/* Forward Declarations */
+
+typedef struct byte_histogram_t byte_histogram_t;
+
+/* N-gram Model Constants */
+
+/* The default model file name. ngram-train writes it to the working
+ * directory, which is the products directory when run from Xcode. */
+#define NGRAM_MODEL_DEFAULT_PATH "english.ngram"
+
+/* The first bytes of every model file */
+#define NGRAM_MODEL_MAGIC "MCNGRAM"
+#define NGRAM_MODEL_MAGIC_LENGTH 8
+
+/* Increment this when the model file layout changes */
+#define NGRAM_MODEL_VERSION 1
+
+/* Written in host byte order. Models are mapped without parsing, so they
+ * can only be loaded on machines with the same byte order. */
+#define NGRAM_MODEL_BYTE_ORDER 0x01020304
+
+/* Log-probabilities are fixed-point log2 probabilities, with this many
+ * units per bit */
+#define NGRAM_BIT_SCALE 256
+
+/* Trigrams are counted over bytes folded into this many classes:
+ * letters (case-insensitive), space, digits, sentence punctuation,
+ * other whitespace, other printable characters, and everything else. */
+#define NGRAM_CLASS_COUNT 32
+
+#define NGRAM_BIGRAM_COUNT (BYTE_VALUE_COUNT * BYTE_VALUE_COUNT)
+#define NGRAM_TRIGRAM_COUNT \
+                  (NGRAM_CLASS_COUNT * NGRAM_CLASS_COUNT * NGRAM_CLASS_COUNT)
+
+/* Data Types */
+
+/* The header at the start of every model file.
+ * The tables follow the header at the given offsets:
+ * - class_map: uint8_t[BYTE_VALUE_COUNT], the trigram class of each byte
+ * - unigram: int16_t[BYTE_VALUE_COUNT], log2 P(byte)
+ * - bigram: int16_t[BYTE_VALUE_COUNT][BYTE_VALUE_COUNT],
+ *   log2 P(byte | previous byte)
+ * - trigram: int16_t[NGRAM_CLASS_COUNT]^3,
+ *   log2 P(class | two previous classes) */
+typedef struct ngram_model_header_t {
+  char magic[NGRAM_MODEL_MAGIC_LENGTH];
+  uint32_t version;
+  uint32_t byte_order;
+  uint32_t header_length;
+  uint32_t bit_scale;
+  uint32_t class_count;
+  uint32_t reserved;
+  /* The number of bytes in the training corpus */
+  uint64_t corpus_length;
+  uint64_t class_map_offset;
+  uint64_t unigram_offset;
+  uint64_t bigram_offset;
+  uint64_t trigram_offset;
+  uint64_t file_length;
+} ngram_model_header_t;
+
+/* A model mapped from a file. The tables point into the mapping. */
+typedef struct ngram_model_t {
+  void *mapping;
+  size_t mapping_length;
+  const ngram_model_header_t *header;
+  const uint8_t *class_map;
+  const int16_t *unigram;
+  const int16_t *bigram;
+  const int16_t *trigram;
+} ngram_model_t;
+
+/* The counts used to train a model */
+typedef struct ngram_counts_t {
+  uint64_t length;
+  uint64_t unigram[BYTE_VALUE_COUNT];
+  uint64_t bigram[NGRAM_BIGRAM_COUNT];
+  uint64_t trigram[NGRAM_TRIGRAM_COUNT];
+} ngram_counts_t;
+
+/* Function Declarations */
+
+uint8_t ngram_byte_class(uint8_t byte);
+
+ngram_counts_t *ngram_counts_alloc(void);
+void ngram_counts_free(ngram_counts_t *counts);
+void ngram_counts_add_text(ngram_counts_t *counts, const uint8_t *bytes,
+                           size_t length);
+bool ngram_model_write(const ngram_counts_t *counts, const char *path);
+
+ngram_model_t *ngram_model_load(const char *path);
+void ngram_model_free(ngram_model_t *model);
+
+int64_t ngram_model_log_likelihood_sum(const ngram_model_t *model,
+                                       const uint8_t *bytes, size_t length);
+double ngram_model_score_bytes(const ngram_model_t *model,
+                               const uint8_t *bytes, size_t length);
+double ngram_model_score_histogram(const ngram_model_t *model,
+                                   const byte_histogram_t *histogram,
+                                   uint8_t key);
+
+#endif /* ngram_h */
@@ -0,0 +1,310 @@
+//
+//  parallel.c
+//  MatasanoCrypto
+//
+//  Created by Tim Wilson-Brown on 18/10/2026.
+//  Copyright © 2026 teor - gmail: teor2345
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "parallel.h"
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/* Private Data Types */
+
+/* The state shared by all the threads in a parallel_for() */
+typedef struct parallel_job_t {
+  size_t count;
+  parallel_task_func task;
+  void *context;
+  /* The next item index that hasn't been claimed by a thread */
+  atomic_size_t next_index;
+} parallel_job_t;
+
+/* The state of a single worker thread */
+typedef struct parallel_worker_t {
+  parallel_job_t *job;
+  size_t thread_index;
+  /* The pool that owns this worker, or NULL for the calling thread */
+  parallel_pool_t *pool;
+} parallel_worker_t;
+
+/* A set of worker threads that stay running between jobs, so repeated
+ * parallel loops don't pay for thread creation every time. */
+struct parallel_pool_t {
+  /* The worker threads, plus the calling thread as thread 0 */
+  size_t thread_count;
+  parallel_worker_t workers[PARALLEL_MAX_THREADS];
+  pthread_t thread_ids[PARALLEL_MAX_THREADS];
+
+  /* Protects the fields below, and publishes job to the workers */
+  pthread_mutex_t mutex;
+  /* Signalled when there is a new job, or the pool is shutting down */
+  pthread_cond_t job_posted;
+  /* Signalled when the last worker finishes the current job */
+  pthread_cond_t job_done;
+  /* Incremented for each new job */
+  size_t generation;
+  /* The number of workers still running the current job */
+  size_t busy_count;
+  bool shutdown;
+
+  parallel_job_t job;
+};
+
+/* Return the number of threads to use for requested_thread_count.
+ * If requested_thread_count is PARALLEL_THREADS_AUTO, returns the number of
+ * online CPUs. The result is always between 1 and PARALLEL_MAX_THREADS. */
+size_t
+parallel_thread_count(size_t requested_thread_count)
+{
+  size_t result = requested_thread_count;
+
+  if (result == PARALLEL_THREADS_AUTO) {
+    const long cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+    result = (cpu_count > 0 ? (size_t)cpu_count : 1);
+  }
+
+  if (result > PARALLEL_MAX_THREADS) {
+    result = PARALLEL_MAX_THREADS;
+  }
+
+  assert(result >= 1);
+  assert(result <= PARALLEL_MAX_THREADS);
+  return result;
+}
+
+/* Claim and run items from worker->job until there are none left.
+ * Items are claimed one at a time, so threads that finish early take more
+ * items. */
+static void *
+parallel_worker_run(void *arg)
+{
+  parallel_worker_t * const worker = arg;
+  assert(worker != NULL);
+  parallel_job_t * const job = worker->job;
+  assert(job != NULL);
+
+  while (1) {
+    const size_t index = atomic_fetch_add(&job->next_index, 1);
+    if (index >= job->count) {
+      break;
+    }
+
+    job->task(index, worker->thread_index, job->context);
+  }
+
+  return NULL;
+}
+
+/* Wait for jobs on worker->pool, and run each one, until the pool shuts
+ * down. */
+static void *
+parallel_pool_worker_main(void *arg)
+{
+  parallel_worker_t * const worker = arg;
+  assert(worker != NULL);
+  parallel_pool_t * const pool = worker->pool;
+  assert(pool != NULL);
+
+  /* Pools start at generation 0. A worker that starts after the first job
+   * is posted still runs it, and parallel_pool_for() waits for every worker,
+   * so no worker can miss a later job. */
+  size_t seen_generation = 0;
+
+  pthread_mutex_lock(&pool->mutex);
+
+  while (1) {
+    while (!pool->shutdown && pool->generation == seen_generation) {
+      pthread_cond_wait(&pool->job_posted, &pool->mutex);
+    }
+
+    if (pool->shutdown) {
+      break;
+    }
+
+    seen_generation = pool->generation;
+    pthread_mutex_unlock(&pool->mutex);
+
+    parallel_worker_run(worker);
+
+    pthread_mutex_lock(&pool->mutex);
+    assert(pool->busy_count > 0);
+    pool->busy_count--;
+    if (pool->busy_count == 0) {
+      pthread_cond_signal(&pool->job_done);
+    }
+  }
+
+  pthread_mutex_unlock(&pool->mutex);
+  return NULL;
+}
+
+/* Allocate a pool with up to thread_count threads (see
+ * parallel_thread_count()), including the calling thread. The worker
+ * threads are started now, and wait for parallel_pool_for() jobs until the
+ * pool is freed. */
+parallel_pool_t *
+parallel_pool_alloc(size_t thread_count)
+{
+  parallel_pool_t * const pool = calloc(1, sizeof(*pool));
+  assert(pool != NULL);
+
+  int rv = pthread_mutex_init(&pool->mutex, NULL);
+  assert(rv == 0);
+  rv = pthread_cond_init(&pool->job_posted, NULL);
+  assert(rv == 0);
+  rv = pthread_cond_init(&pool->job_done, NULL);
+  assert(rv == 0);
+  (void)rv;
+
+  pool->generation = 0;
+  pool->busy_count = 0;
+  pool->shutdown = false;
+  atomic_init(&pool->job.next_index, 0);
+
+  /* Thread 0 is the calling thread */
+  pool->workers[0].job = &pool->job;
+  pool->workers[0].thread_index = 0;
+  pool->workers[0].pool = NULL;
+  pool->thread_count = 1;
+
+  const size_t threads = parallel_thread_count(thread_count);
+  for (size_t i = 1; i < threads; i++) {
+    parallel_worker_t * const worker = &pool->workers[pool->thread_count];
+    worker->job = &pool->job;
+    worker->thread_index = pool->thread_count;
+    worker->pool = pool;
+
+    /* If we can't start a thread, the other threads do its work */
+    if (pthread_create(&pool->thread_ids[pool->thread_count], NULL,
+                       &parallel_pool_worker_main, worker) == 0) {
+      pool->thread_count++;
+    }
+  }
+
+  assert(pool->thread_count >= 1);
+  assert(pool->thread_count <= threads);
+  return pool;
+}
+
+/* Stop the threads in pool, and free it. pool must not be running a job.
+ * Use the parallel_pool_free() macro, which also sets pool to NULL. */
+void
+parallel_pool_free_(parallel_pool_t *pool)
+{
+  if (pool == NULL) {
+    return;
+  }
+
+  pthread_mutex_lock(&pool->mutex);
+  assert(pool->busy_count == 0);
+  pool->shutdown = true;
+  pthread_cond_broadcast(&pool->job_posted);
+  pthread_mutex_unlock(&pool->mutex);
+
+  for (size_t i = 1; i < pool->thread_count; i++) {
+    int rv = pthread_join(pool->thread_ids[i], NULL);
+    assert(rv == 0);
+    (void)rv;
+  }
+
+  pthread_cond_destroy(&pool->job_done);
+  pthread_cond_destroy(&pool->job_posted);
+  pthread_mutex_destroy(&pool->mutex);
+  free(pool);
+}
+
+/* Run task for each index from 0 to count - 1 on the threads in pool.
+ * Returns when every task is done. Tasks may run in any order, so they must
+ * only share context using per-index or per-thread fields.
+ * The calling thread runs tasks as thread 0. If pool only has the calling
+ * thread, or there is only one item, all the tasks run on the calling thread
+ * in index order.
+ * Only one thread may use pool at a time. */
+void
+parallel_pool_for(parallel_pool_t *pool, size_t count,
+                  parallel_task_func task, void *context)
+{
+  assert(pool != NULL);
+  assert(task != NULL);
+
+  if (count == 0) {
+    return;
+  }
+
+  if (pool->thread_count == 1 || count == 1) {
+    for (size_t i = 0; i < count; i++) {
+      task(i, 0, context);
+    }
+    return;
+  }
+
+  pthread_mutex_lock(&pool->mutex);
+  assert(pool->busy_count == 0);
+  pool->job.count = count;
+  pool->job.task = task;
+  pool->job.context = context;
+  atomic_store(&pool->job.next_index, 0);
+  pool->busy_count = pool->thread_count - 1;
+  pool->generation++;
+  pthread_cond_broadcast(&pool->job_posted);
+  pthread_mutex_unlock(&pool->mutex);
+
+  parallel_worker_run(&pool->workers[0]);
+
+  pthread_mutex_lock(&pool->mutex);
+  while (pool->busy_count > 0) {
+    pthread_cond_wait(&pool->job_done, &pool->mutex);
+  }
+  pthread_mutex_unlock(&pool->mutex);
+
+  assert(atomic_load(&pool->job.next_index) >= count);
+}
+
+/* Run task for each index from 0 to count - 1, using up to thread_count
+ * threads (see parallel_thread_count()). Returns when every task is done.
+ * Tasks may run in any order, so they must only share context using
+ * per-index or per-thread fields.
+ * The calling thread runs tasks as thread 0. If thread_count is 1, or there
+ * is only one item, all the tasks run on the calling thread in index order.
+ */
+void
+parallel_for(size_t count, size_t thread_count, parallel_task_func task,
+             void *context)
+{
+  assert(task != NULL);
+
+  if (count == 0) {
+    return;
+  }
+
+  size_t threads = parallel_thread_count(thread_count);
+  if (threads > count) {
+    threads = count;
+  }
+
+  /* One-off loops pay for their threads here. Callers with repeated loops
+   * should keep a pool. */
+  parallel_pool_t *pool = parallel_pool_alloc(threads);
+  parallel_pool_for(pool, count, task, context);
+  parallel_pool_free(pool);
+}
@@ -0,0 +1,65 @@
+//
+//  parallel.h
+//  MatasanoCrypto
+//
+//  Created by Tim Wilson-Brown on 18/10/2026.
+//  Copyright © 2026 teor - gmail: teor2345
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef parallel_h
+#define parallel_h
+
+#include <sys/types.h>
+
+/* Forward Declarations */
+
+typedef struct parallel_pool_t parallel_pool_t;
+
+/* Parallel Constants */
+
+/* Pass this as thread_count to use one thread per online CPU */
+#define PARALLEL_THREADS_AUTO 0
+
+/* The most threads we'll ever start for a single parallel_for() or pool */
+#define PARALLEL_MAX_THREADS 256
+
+/* Data Types */
+
+/* A task that processes item index, running on thread thread_index.
+ * thread_index is less than the thread count returned by
+ * parallel_thread_count(), so it can be used to index per-thread scratch
+ * buffers. */
+typedef void (*parallel_task_func)(size_t index, size_t thread_index,
+                                   void *context);
+
+/* Function Declarations */
+
+size_t parallel_thread_count(size_t requested_thread_count);
+void parallel_for(size_t count, size_t thread_count, parallel_task_func task,
+                  void *context);
+
+parallel_pool_t *parallel_pool_alloc(size_t thread_count);
+void parallel_pool_free_(parallel_pool_t *pool);
+#define parallel_pool_free(pool) \
+  do { \
+    parallel_pool_free_(pool); \
+    pool = NULL; \
+  } while (0)
+
+void parallel_pool_for(parallel_pool_t *pool, size_t count,
+                       parallel_task_func task, void *context);
+
+#endif /* parallel_h */
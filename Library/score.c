@@ -34,6 +34,10 @@
 #include "bytearray.h"
 #include "char.h"
 #include "hex.h"
+#include "histogram.h"
+#include "model.h"
+#include "ngram.h"
+#include "topk.h"
 
 /* Is byte a printable ASCII character?
  * Assumes that byte will be type cast into an ASCII char.
@@ -64,6 +68,37 @@ is_byte_ascii_space(uint8_t byte)
   return c == ' ';
 }
 
+/* Byte Classes */
+
+/* Each byte's classes, as a bitmask of BYTE_CLASS_* values.
+ * These match is_byte_ascii_printable(), is_byte_ascii_letter() and
+ * is_byte_ascii_space(), but they're built at compile time, so they can be
+ * used in table lookups. */
+#define BYTE_CLASS_PRINTABLE 0x01
+#define BYTE_CLASS_LETTER    0x02
+#define BYTE_CLASS_SPACE     0x04
+
+#define BYTE_CLASS(b) \
+  (((b) >= ' ' && (b) <= '~' ? BYTE_CLASS_PRINTABLE : 0) \
+   | (((b) >= 'A' && (b) <= 'Z') || ((b) >= 'a' && (b) <= 'z') \
+      ? BYTE_CLASS_LETTER : 0) \
+   | ((b) == ' ' ? BYTE_CLASS_SPACE : 0))
+
+static const uint8_t byte_class_table[BYTE_VALUE_COUNT] = {
+  BYTE_TABLE(BYTE_CLASS)
+};
+
+/* Each byte's case-insensitive letter index: 0 for 'a' and 'A', up to 25 for
+ * 'z' and 'Z'. Non-letters are LETTER_COUNT, so they can be counted in a
+ * spare slot without branching. */
+#define LETTER_INDEX(b) \
+  ((b) >= 'a' && (b) <= 'z' ? (b) - 'a' \
+   : ((b) >= 'A' && (b) <= 'Z' ? (b) - 'A' : LETTER_COUNT))
+
+static const uint8_t letter_index_table[BYTE_VALUE_COUNT] = {
+  BYTE_TABLE(LETTER_INDEX)
+};
+
 /* Convert the byte array bytearray into a newly allocated ASCII
  * nul-terminated string, escaping non-printable characters using "\xHH".
  * Never returns a NULL char *. If bytearray has a zero length, the returned
@@ -120,27 +155,22 @@ bytearray_to_escstr(const bytearray_t *bytearray)
   return asciistr;
 }
 
-typedef bool (*byte_test_func)(uint8_t);
-
-/* Return the number of bytes in bytearray satisfying byte_test. */
+/* Return the number of bytes in histogram whose byte class includes any of
+ * the BYTE_CLASS_* bits in class_mask. */
 static size_t
-count_byte_test(const bytearray_t *bytearray, byte_test_func byte_test)
+histogram_count_class(const byte_histogram_t *histogram, uint8_t class_mask)
 {
-  assert(bytearray != NULL);
-  assert(is_bytearray_consistent(bytearray));
-  assert(byte_test != NULL);
+  assert(histogram != NULL);
 
   size_t result = 0;
 
-  for (size_t i = 0; i < bytearray_length(bytearray); i++) {
-    uint8_t byte = bytearray_get_checked(bytearray, i);
-
-    if (byte_test(byte)) {
-      result++;
+  for (size_t b = 0; b < BYTE_VALUE_COUNT; b++) {
+    if (byte_class_table[b] & class_mask) {
+      result += histogram->counts[b];
     }
   }
 
-  assert(result <= bytearray_length(bytearray));
+  assert(result <= histogram->length);
 
   return result;
 }
@@ -149,14 +179,20 @@ count_byte_test(const bytearray_t *bytearray, byte_test_func byte_test)
 size_t
 count_printable(const bytearray_t *bytearray)
 {
-  return count_byte_test(bytearray, &is_byte_ascii_printable);
+  byte_histogram_t histogram;
+  bytearray_histogram(bytearray, &histogram);
+
+  return histogram_count_class(&histogram, BYTE_CLASS_PRINTABLE);
 }
 
 /* Return the number of ASCII space characters in bytearray. */
 size_t
 count_space(const bytearray_t *bytearray)
 {
-  return count_byte_test(bytearray, &is_byte_ascii_space);
+  byte_histogram_t histogram;
+  bytearray_histogram(bytearray, &histogram);
+
+  return histogram_count_class(&histogram, BYTE_CLASS_SPACE);
 }
 
 /* Return the number of ASCII letter characters in bytearray.
@@ -164,11 +200,13 @@ count_space(const bytearray_t *bytearray)
 size_t
 count_letter(const bytearray_t *bytearray, bool include_space)
 {
-  size_t result = count_byte_test(bytearray, &is_byte_ascii_letter);
+  byte_histogram_t histogram;
+  bytearray_histogram(bytearray, &histogram);
 
-  if (include_space) {
-    result += count_space(bytearray);
-  }
+  const uint8_t class_mask = (include_space
+                              ? BYTE_CLASS_LETTER | BYTE_CLASS_SPACE
+                              : BYTE_CLASS_LETTER);
+  size_t result = histogram_count_class(&histogram, class_mask);
 
   assert(result <= bytearray_length(bytearray));
 
@@ -179,28 +217,58 @@ count_letter(const bytearray_t *bytearray, bool include_space)
 size_t
 count_byte(const bytearray_t *bytearray, uint8_t byte)
 {
-  /* I'd love to use count_byte_test, but C doesn't have partially-applied
-   * functions */
-  assert(bytearray != NULL);
-  assert(is_bytearray_consistent(bytearray));
+  byte_histogram_t histogram;
+  bytearray_histogram(bytearray, &histogram);
 
-  size_t result = 0;
+  size_t result = histogram.counts[byte];
+
+  assert(result <= bytearray_length(bytearray));
+
+  return result;
+}
 
-  for (size_t i = 0; i < bytearray_length(bytearray); i++) {
-    uint8_t ba_byte = bytearray_get_checked(bytearray, i);
+/* Calculate the frequencies of each letter from letter_count, and place them
+ * in frequencies_out. total_letter_count is the sum of letter_count.
+ * Case-insensitive: letter_count[0] is the number of 'a' and 'A'. */
+static void
+letter_count_to_frequency(const size_t letter_count[LETTER_COUNT],
+                          size_t total_letter_count,
+                          double frequencies_out[LETTER_COUNT])
+{
+  for (uint8_t i = 0; i < LETTER_COUNT; i++) {
+    assert(letter_count[i] <= total_letter_count);
 
-    if (byte == ba_byte) {
-      result++;
+    if (total_letter_count > 0) {
+      frequencies_out[i] = (double)letter_count[i]/(double)total_letter_count;
+    } else {
+      frequencies_out[i] = 0.0;
     }
+    assert(frequencies_out[i] >= 0.0);
+  }
+}
+
+/* Count each letter in histogram, and place the counts in letter_count_out.
+ * Case-insensitive: letter_count_out[0] is the number of 'a' and 'A'.
+ * Returns the total number of letters. */
+static size_t
+histogram_count_letters(const byte_histogram_t *histogram,
+                        size_t letter_count_out[LETTER_COUNT])
+{
+  assert(histogram != NULL);
+
+  size_t total_letter_count = 0;
+
+  for (uint8_t i = 0; i < LETTER_COUNT; i++) {
+    letter_count_out[i] = (histogram->counts['a' + i]
+                           + histogram->counts['A' + i]);
+    total_letter_count += letter_count_out[i];
   }
 
-  assert(result <= bytearray_length(bytearray));
+  assert(total_letter_count <= histogram->length);
 
-  return result;
+  return total_letter_count;
 }
 
-#define LETTER_COUNT 26
-
 /* Calculate the frequencies of each letter in bytearray and place them in
  * frequencies_out.
  * Case-insensitive.
@@ -212,33 +280,15 @@ calculate_letter_frequency(const bytearray_t *bytearray,
   assert(bytearray != NULL);
   assert(is_bytearray_consistent(bytearray));
 
+  byte_histogram_t histogram;
+  bytearray_histogram(bytearray, &histogram);
+
   size_t letter_count[LETTER_COUNT];
-  size_t total_letter_count = count_letter(bytearray, false);
+  size_t total_letter_count = histogram_count_letters(&histogram,
+                                                      letter_count);
 
-  for (uint8_t i = 0; i < LETTER_COUNT; i++) {
-    /* I'd love to use count_byte_test with a case-insensitive letter-matching
-     * function, but C doesn't have partially-applied functions */
-    char letter = 0;
-    bool success = false;
-
-    /* Initialise with lowercase count */
-    success = value_to_char(i, 0, LETTER_COUNT - 1, 'a', &letter);
-    assert(success);
-    letter_count[i] = count_byte(bytearray, (uint8_t)letter);
-
-    /* Add uppercase count */
-    success = value_to_char(i, 0, LETTER_COUNT - 1, 'A', &letter);
-    assert(success);
-    letter_count[i] += count_byte(bytearray, (uint8_t)letter);
-
-    /* Calculate frequency */
-    if (total_letter_count > 0) {
-      frequencies_out[i] = (double)letter_count[i]/(double)total_letter_count;
-    } else {
-      frequencies_out[i] = 0.0;
-    }
-    assert(frequencies_out[i] >= 0.0);
-  }
+  letter_count_to_frequency(letter_count, total_letter_count,
+                            frequencies_out);
 }
 
 /* The average frequencies of the letters a-z in English.
@@ -284,19 +334,11 @@ score_letter_frequency(double actual, double expected)
   return fabs(actual - expected);
 }
 
-/* Calculate the frequencies of each letter in bytearray and scores them
- * against typical English text frequencies. Lower values are better.
- * Case-insensitive.
- * Disregards non-letter characters when calculating frequencies. */
-double
-score_english_letter_frequency(const bytearray_t *bytearray)
+/* Score letter_frequency against typical English text frequencies, using
+ * the root-mean-square of the differences. Lower values are better. */
+static double
+score_letter_frequency_rms(const double letter_frequency[LETTER_COUNT])
 {
-  assert(bytearray != NULL);
-  assert(is_bytearray_consistent(bytearray));
-
-  double letter_frequency[LETTER_COUNT];
-  calculate_letter_frequency(bytearray, letter_frequency);
-
   /* Calculate root-mean-squares using the differences between each letter's
    * actual frequency, and the average English frequency.
    * TODO: is there a better statistical function for this? */
@@ -316,6 +358,22 @@ score_english_letter_frequency(const bytearray_t *bytearray)
   return root_mean_squares;
 }
 
+/* Calculate the frequencies of each letter in bytearray and scores them
+ * against typical English text frequencies. Lower values are better.
+ * Case-insensitive.
+ * Disregards non-letter characters when calculating frequencies. */
+double
+score_english_letter_frequency(const bytearray_t *bytearray)
+{
+  assert(bytearray != NULL);
+  assert(is_bytearray_consistent(bytearray));
+
+  double letter_frequency[LETTER_COUNT];
+  calculate_letter_frequency(bytearray, letter_frequency);
+
+  return score_letter_frequency_rms(letter_frequency);
+}
+
 /* Scoring Heuristics */
 
 /* My estimate of the average English line length is 40 characters */
@@ -408,30 +466,118 @@ score_max_count(size_t count, size_t max_count)
   return score_max_deviation((double)count, (double)max_count);
 }
 
-/* How likely is it that bytearray is English text?
- * The output is between 0.0 and 1.0, higher scores are better.
+/* Incremental Counts */
+
+/* Set every count in counts to zero. */
+void
+english_counts_clear(english_counts_t *counts)
+{
+  assert(counts != NULL);
+
+  memset(counts, 0, sizeof(*counts));
+}
+
+/* Add byte to counts. Takes constant time. */
+void
+english_counts_add_byte(english_counts_t *counts, uint8_t byte)
+{
+  assert(counts != NULL);
+
+  const uint8_t byte_class = byte_class_table[byte];
+  const uint8_t letter_index = letter_index_table[byte];
+
+  counts->length++;
+  counts->printable += (byte_class & BYTE_CLASS_PRINTABLE);
+  counts->letter += (byte_class & BYTE_CLASS_LETTER) >> 1;
+  counts->space += (byte_class & BYTE_CLASS_SPACE) >> 2;
+
+  if (letter_index < LETTER_COUNT) {
+    counts->letter_count[letter_index]++;
+  }
+}
+
+/* Subtract byte from counts. byte must have previously been added to counts.
+ * Takes constant time. */
+void
+english_counts_remove_byte(english_counts_t *counts, uint8_t byte)
+{
+  assert(counts != NULL);
+  assert(counts->length > 0);
+
+  const uint8_t byte_class = byte_class_table[byte];
+  const uint8_t letter_index = letter_index_table[byte];
+
+  counts->length--;
+  counts->printable -= (byte_class & BYTE_CLASS_PRINTABLE);
+  counts->letter -= (byte_class & BYTE_CLASS_LETTER) >> 1;
+  counts->space -= (byte_class & BYTE_CLASS_SPACE) >> 2;
+
+  if (letter_index < LETTER_COUNT) {
+    assert(counts->letter_count[letter_index] > 0);
+    counts->letter_count[letter_index]--;
+  }
+}
+
+/* Set *stop_reason_out to stop_reason, if stop_reason_out is not NULL. */
+static void
+set_stop_reason(score_stop_reason_t *stop_reason_out,
+                score_stop_reason_t stop_reason)
+{
+  if (stop_reason_out != NULL) {
+    *stop_reason_out = stop_reason;
+  }
+}
+
+/* Return an upper bound on the English score of text with counts, using
+ * only its length, printable, letter and space counts. The letter counts
+ * are ignored, so they don't need to be filled in.
+ * The bound is the product of the cheap factors, evaluated in order, and
+ * evaluation stops as soon as a factor is zero, or the upper bound is less
+ * than bound. Then *stop_reason_out (if it's not NULL) is set to the reason.
+ * Otherwise, the letter frequency factor is all that's left, and
+ * *stop_reason_out is set to SCORE_STOP_COMPLETE.
  */
 double
-score_english_text(const bytearray_t *bytearray)
+score_english_class_counts_bounded(const english_counts_t *counts,
+                                   double bound,
+                                   score_stop_reason_t *stop_reason_out)
 {
+  assert(counts != NULL);
+  assert(counts->printable <= counts->length);
+  assert(counts->letter + counts->space <= counts->length);
+
   /* English generally doesn't contain unprintables or non-letters.
-   * On average, English text has certain letter and space frequencies. */
+   * On average, English text has a certain space frequency. */
 
   /* Unprintable Maximum */
-  size_t max_unprint = MAX_UNPRINTABLE(bytearray_length(bytearray));
-  size_t unprint = count_unprintable(bytearray);
+  size_t max_unprint = MAX_UNPRINTABLE(counts->length);
+  size_t unprint = counts->length - counts->printable;
   double unprint_factor = score_max_count(unprint, max_unprint);
   assert(unprint_factor >= 0.0);
 
+  if (unprint_factor == 0.0) {
+    set_stop_reason(stop_reason_out, SCORE_STOP_UNPRINTABLE);
+    return 0.0;
+  }
+
   /* Non-letter Maximum */
-  size_t max_nonlet = MAX_NONLETTER(bytearray_length(bytearray));
-  size_t nonlet = count_nonletter(bytearray, false);
+  size_t max_nonlet = MAX_NONLETTER(counts->length);
+  size_t nonlet = counts->length - (counts->letter + counts->space);
   double nonlet_factor = score_max_count(nonlet, max_nonlet);
   assert(nonlet_factor >= 0.0);
 
+  double upper_bound = unprint_factor * nonlet_factor;
+  if (nonlet_factor == 0.0) {
+    set_stop_reason(stop_reason_out, SCORE_STOP_NONLETTER);
+    return 0.0;
+  } else if (upper_bound < bound) {
+    set_stop_reason(stop_reason_out, SCORE_STOP_BOUND);
+    return upper_bound;
+  }
+
   /* Space Frequency */
-  size_t space_count = count_space(bytearray);
-  double space_freq = space_count / (double)bytearray_length(bytearray);
+  size_t space_count = counts->space;
+  double space_freq = space_count / (double)counts->length;
   double space_dev = score_letter_frequency(space_freq,
                                               EXPECTED_SPACE_FREQUENCY);
   double scaled_space_dev = scale_good_deviation(space_dev,
@@ -439,24 +585,732 @@ score_english_text(const bytearray_t *bytearray)
   double space_factor = score_max_deviation(scaled_space_dev,
                                             MAX_SPACE_DEVIATION);
 
+  upper_bound *= space_factor;
+  if (space_factor == 0.0) {
+    set_stop_reason(stop_reason_out, SCORE_STOP_SPACE);
+    return 0.0;
+  } else if (upper_bound < bound) {
+    set_stop_reason(stop_reason_out, SCORE_STOP_BOUND);
+    return upper_bound;
+  }
+
+#if SCORE_DEBUG
+  printf("Unprintable:           %zu <= %zu -> %.3f\n", unprint, max_unprint, unprint_factor);
+  printf("Non-Letter:            %zu <= %zu -> %.3f\n", nonlet, max_nonlet, nonlet_factor);
+  printf("Space (Word Length):   %.3f <= %.3f <= %.3f -> %.3f\n", GOOD_SPACE_DEVIATION, space_dev, MAX_SPACE_DEVIATION, space_factor);
+#endif
+
+  set_stop_reason(stop_reason_out, SCORE_STOP_COMPLETE);
+  return upper_bound;
+}
+
+/* How likely is it that text with counts is English text?
+ * The output is between 0.0 and 1.0, higher scores are better.
+ * The score is a product of factors between 0.0 and 1.0, so the product of
+ * the factors evaluated so far is an upper bound on the score. The cheap
+ * factors are evaluated first, and scoring stops as soon as a factor is
+ * zero, or the upper bound is less than bound.
+ * If scoring stops early, returns the upper bound, and sets
+ * *stop_reason_out (if it's not NULL) to the reason. The upper bound is 0.0
+ * when a factor is zero, and less than bound otherwise. If the score is
+ * complete, sets *stop_reason_out to SCORE_STOP_COMPLETE.
+ */
+double
+score_english_counts_bounded(const english_counts_t *counts, double bound,
+                             score_stop_reason_t *stop_reason_out)
+{
+  score_stop_reason_t class_stop_reason = SCORE_STOP_COMPLETE;
+  double upper_bound = score_english_class_counts_bounded(counts, bound,
+                                                          &class_stop_reason);
+  if (class_stop_reason != SCORE_STOP_COMPLETE) {
+    set_stop_reason(stop_reason_out, class_stop_reason);
+    return upper_bound;
+  }
+
   /* Letter Frequency */
-  double english_dev = score_english_letter_frequency(bytearray);
+  double letter_frequency[LETTER_COUNT];
+  letter_count_to_frequency(counts->letter_count, counts->letter,
+                            letter_frequency);
+  double english_dev = score_letter_frequency_rms(letter_frequency);
   double scaled_english_dev = scale_good_deviation(english_dev,
                                                    GOOD_ENGLISH_DEVIATION);
   double english_factor = score_max_deviation(scaled_english_dev,
                                               MAX_ENGLISH_DEVIATION);
 
-  double result = (unprint_factor * nonlet_factor * space_factor
-                   * english_factor);
+  double result = upper_bound * english_factor;
 
 #if SCORE_DEBUG
-  printf("Unprintable:           %zu <= %zu -> %.3f\n", unprint, max_unprint, unprint_factor);
-  printf("Non-Letter:            %zu <= %zu -> %.3f\n", nonlet, max_nonlet, nonlet_factor);
-  printf("Space (Word Length):   %.3f <= %.3f <= %.3f -> %.3f\n", GOOD_SPACE_DEVIATION, space_dev, MAX_SPACE_DEVIATION, space_factor);
   printf("English Text Score:    %.3f <= %.3f <= %.3f -> %.3f\n", GOOD_ENGLISH_DEVIATION, english_dev, MAX_ENGLISH_DEVIATION, english_factor);
 #endif
 
   assert(result >= 0.0);
   assert(result <= 1.0);
+  set_stop_reason(stop_reason_out, SCORE_STOP_COMPLETE);
   return result;
 }
+
+/* How likely is it that text with counts is English text?
+ * The output is between 0.0 and 1.0, higher scores are better.
+ */
+static double
+score_english_counts(const english_counts_t *counts)
+{
+  /* A zero bound only stops early when the score is zero */
+  return score_english_counts_bounded(counts, 0.0, NULL);
+}
+
+/* Place the counts used to score the text counted in histogram in
+ * counts_out. */
+static void
+histogram_to_english_counts(const byte_histogram_t *histogram,
+                            english_counts_t *counts_out)
+{
+  assert(histogram != NULL);
+  assert(counts_out != NULL);
+
+  counts_out->length = histogram->length;
+  counts_out->printable = histogram_count_class(histogram,
+                                                BYTE_CLASS_PRINTABLE);
+  counts_out->space = histogram_count_class(histogram, BYTE_CLASS_SPACE);
+  counts_out->letter = histogram_count_letters(histogram,
+                                               counts_out->letter_count);
+}
+
+/* How likely is it that the text counted in histogram is English text?
+ * The output is between 0.0 and 1.0, higher scores are better.
+ * Takes constant time, regardless of the length of the text.
+ */
+double
+score_english_histogram(const byte_histogram_t *histogram)
+{
+  english_counts_t counts;
+  histogram_to_english_counts(histogram, &counts);
+
+  return score_english_counts(&counts);
+}
+
+/* How likely is it that bytearray is English text?
+ * The output is between 0.0 and 1.0, higher scores are better.
+ * Makes a single pass over bytearray.
+ */
+double
+score_english_text(const bytearray_t *bytearray)
+{
+  assert(bytearray != NULL);
+  assert(is_bytearray_consistent(bytearray));
+
+  byte_histogram_t histogram;
+  bytearray_histogram(bytearray, &histogram);
+
+  return score_english_histogram(&histogram);
+}
+
+/* Bounded Scoring */
+
+/* Count the length bytes at bytes into histogram_out, stopping early if the
+ * text can't score at least bound, because it has too many unprintable or
+ * non-letter bytes.
+ * Returns true if every byte was counted. Otherwise, returns false, and sets
+ * *upper_bound_out and *stop_reason_out, like
+ * score_english_counts_bounded(). */
+static bool
+scan_english_bytes_bounded(const uint8_t *bytes, size_t length, double bound,
+                           byte_histogram_t *histogram_out,
+                           double *upper_bound_out,
+                           score_stop_reason_t *stop_reason_out)
+{
+  assert(bytes != NULL);
+  assert(histogram_out != NULL);
+  assert(upper_bound_out != NULL);
+  assert(stop_reason_out != NULL);
+
+  const size_t max_unprint = MAX_UNPRINTABLE(length);
+  const size_t max_nonlet = MAX_NONLETTER(length);
+  size_t unprint = 0;
+  size_t nonlet = 0;
+
+  byte_histogram_clear(histogram_out);
+
+  for (size_t i = 0; i < length; i++) {
+    const uint8_t byte = bytes[i];
+    const uint8_t byte_class = byte_class_table[byte];
+
+    histogram_out->counts[byte]++;
+
+    /* The factors only depend on counts that increase, so they can only
+     * get worse. Letters and spaces don't change them. */
+    if (!(byte_class & (BYTE_CLASS_LETTER | BYTE_CLASS_SPACE))) {
+      nonlet++;
+      if (!(byte_class & BYTE_CLASS_PRINTABLE)) {
+        unprint++;
+      }
+
+      if (unprint > max_unprint) {
+        *upper_bound_out = 0.0;
+        *stop_reason_out = SCORE_STOP_UNPRINTABLE;
+        return false;
+      } else if (nonlet > max_nonlet) {
+        *upper_bound_out = 0.0;
+        *stop_reason_out = SCORE_STOP_NONLETTER;
+        return false;
+      }
+
+      const double upper_bound = (score_max_count(unprint, max_unprint)
+                                  * score_max_count(nonlet, max_nonlet));
+      if (upper_bound < bound) {
+        *upper_bound_out = upper_bound;
+        *stop_reason_out = SCORE_STOP_BOUND;
+        return false;
+      }
+    }
+  }
+
+  histogram_out->length = length;
+
+  return true;
+}
+
+/* How likely is it that bytearray is English text, if it can score at least
+ * bound?
+ * Returns the same score as score_english_text() if it is at least bound.
+ * Stops as soon as the score can't reach bound, evaluating the cheapest
+ * factors first. Most wrong single-byte XOR keys stop after a few bytes.
+ * If scoring stops early, returns an upper bound on the score that is less
+ * than bound (0.0 if a factor is zero).
+ * If stop_reason_out is not NULL, sets it to the reason scoring stopped, or
+ * SCORE_STOP_COMPLETE if it didn't stop early.
+ * bytearray must not be empty. */
+double
+score_english_text_bounded(const bytearray_t *bytearray, double bound,
+                           score_stop_reason_t *stop_reason_out)
+{
+  assert(bytearray != NULL);
+  assert(is_bytearray_consistent(bytearray));
+  assert(bytearray_length(bytearray) > 0);
+
+  const size_t length = bytearray_length(bytearray);
+  byte_histogram_t histogram;
+  double upper_bound = 0.0;
+  score_stop_reason_t stop_reason = SCORE_STOP_COMPLETE;
+
+  if (!scan_english_bytes_bounded(bytearray_const_pointer_checked(bytearray,
+                                                                  0,
+                                                                  length),
+                                  length, bound, &histogram, &upper_bound,
+                                  &stop_reason)) {
+    set_stop_reason(stop_reason_out, stop_reason);
+    return upper_bound;
+  }
+
+  english_counts_t counts;
+  histogram_to_english_counts(&histogram, &counts);
+
+  return score_english_counts_bounded(&counts, bound, stop_reason_out);
+}
+
+/* Single-byte XOR Key Search */
+
+/* The per-key class counts for every single-byte XOR key */
+typedef struct all_keys_counts_t {
+  size_t printable[BYTE_VALUE_COUNT];
+  size_t letter[BYTE_VALUE_COUNT];
+  size_t space[BYTE_VALUE_COUNT];
+} all_keys_counts_t;
+
+/* Count the printable, letter and space bytes in histogram, XORed with every
+ * key, and add them to counts_out.
+ * XORing with key permutes the histogram: the count for byte ^ key is the
+ * count for byte. So this takes at most 256 steps for each distinct byte
+ * value in histogram, regardless of the length of the text. */
+static void
+count_all_keys_histogram(const byte_histogram_t *histogram,
+                         all_keys_counts_t *counts_out)
+{
+  assert(histogram != NULL);
+  assert(counts_out != NULL);
+
+  for (size_t byte = 0; byte < BYTE_VALUE_COUNT; byte++) {
+    const size_t count = histogram->counts[byte];
+
+    if (count == 0) {
+      continue;
+    }
+
+    for (size_t key = 0; key < BYTE_VALUE_COUNT; key++) {
+      const uint8_t byte_class = byte_class_table[byte ^ key];
+
+      counts_out->printable[key] += count * (byte_class
+                                             & BYTE_CLASS_PRINTABLE);
+      counts_out->letter[key] += count * ((byte_class
+                                           & BYTE_CLASS_LETTER) >> 1);
+      counts_out->space[key] += count * ((byte_class
+                                          & BYTE_CLASS_SPACE) >> 2);
+    }
+  }
+}
+
+/* Place the counts for the text counted in histogram XORed with key, using
+ * the per-key class counts in all_counts, in counts_out. */
+static void
+all_keys_counts_to_english_counts(const byte_histogram_t *histogram,
+                                  const all_keys_counts_t *all_counts,
+                                  uint8_t key, english_counts_t *counts_out)
+{
+  assert(histogram != NULL);
+  assert(all_counts != NULL);
+  assert(counts_out != NULL);
+
+  counts_out->length = histogram->length;
+  counts_out->printable = all_counts->printable[key];
+  counts_out->letter = all_counts->letter[key];
+  counts_out->space = all_counts->space[key];
+
+  /* The letter counts for each key are a permutation of the histogram */
+  for (uint8_t i = 0; i < LETTER_COUNT; i++) {
+    counts_out->letter_count[i] = (histogram->counts[('a' + i) ^ key]
+                                   + histogram->counts[('A' + i) ^ key]);
+  }
+}
+
+/* Score the text counted in histogram XORed with every single-byte key,
+ * using the per-key class counts in all_counts, and place the results in
+ * scores_out. Keys that can't score at least bound stop early, see
+ * score_english_counts_bounded(). */
+static void
+score_all_keys_counts(const byte_histogram_t *histogram,
+                      const all_keys_counts_t *all_counts, double bound,
+                      double scores_out[BYTE_VALUE_COUNT])
+{
+  assert(histogram != NULL);
+  assert(all_counts != NULL);
+  assert(scores_out != NULL);
+
+  for (size_t key = 0; key < BYTE_VALUE_COUNT; key++) {
+    english_counts_t counts;
+    all_keys_counts_to_english_counts(histogram, all_counts, (uint8_t)key,
+                                      &counts);
+
+    scores_out[key] = score_english_counts_bounded(&counts, bound, NULL);
+  }
+}
+
+/* Score the text counted in histogram XORed with every single-byte key, as
+ * if each decryption was passed to score_english_text(), and place the
+ * results in scores_out. scores_out[key] is the score for key.
+ * Takes constant time, regardless of the length of the text. */
+void
+score_english_histogram_all_keys(const byte_histogram_t *histogram,
+                                 double scores_out[BYTE_VALUE_COUNT])
+{
+  /* A zero bound only stops early when the score is zero */
+  score_english_histogram_all_keys_bounded(histogram, 0.0, scores_out);
+}
+
+/* Like score_english_histogram_all_keys(), but keys stop scoring as soon as
+ * they can't score at least bound. Those keys' scores are upper bounds that
+ * are less than bound. The scores of the other keys are exact. */
+void
+score_english_histogram_all_keys_bounded(const byte_histogram_t *histogram,
+                                         double bound,
+                                         double scores_out[BYTE_VALUE_COUNT])
+{
+  assert(histogram != NULL);
+  assert(scores_out != NULL);
+
+  all_keys_counts_t all_counts;
+  memset(&all_counts, 0, sizeof(all_counts));
+
+  count_all_keys_histogram(histogram, &all_counts);
+  score_all_keys_counts(histogram, &all_counts, bound, scores_out);
+}
+
+/* Is the key_score_t key_score a better key than the key_score_t other?
+ * Higher scores are better, ties are broken by lower key values.
+ * A topk_better_func. */
+bool
+is_key_score_better(const void *key_score, const void *other)
+{
+  const key_score_t * const key_score_a = key_score;
+  const key_score_t * const key_score_b = other;
+  assert(key_score_a != NULL);
+  assert(key_score_b != NULL);
+
+  if (key_score_a->score != key_score_b->score) {
+    return key_score_a->score > key_score_b->score;
+  } else {
+    return key_score_a->key < key_score_b->key;
+  }
+}
+
+/* Score the text counted in histogram XORed with every single-byte key, and
+ * place the top_count best keys in top_out, best first.
+ * Returns the number of keys placed in top_out, which is the smaller of
+ * top_count and BYTE_VALUE_COUNT.
+ * Takes constant time, regardless of the length of the text. */
+size_t
+score_english_histogram_top_keys(const byte_histogram_t *histogram,
+                                 key_score_t *top_out, size_t top_count)
+{
+  assert(histogram != NULL);
+  assert(top_out != NULL || top_count == 0);
+
+  all_keys_counts_t all_counts;
+  memset(&all_counts, 0, sizeof(all_counts));
+  count_all_keys_histogram(histogram, &all_counts);
+
+  size_t found = 0;
+
+  for (size_t key = 0; key < BYTE_VALUE_COUNT; key++) {
+    /* Once top_out is full, keys must beat its worst score */
+    const double bound = (found == top_count && found > 0
+                          ? top_out[found - 1].score
+                          : 0.0);
+
+    english_counts_t counts;
+    all_keys_counts_to_english_counts(histogram, &all_counts, (uint8_t)key,
+                                      &counts);
+
+    score_stop_reason_t stop_reason = SCORE_STOP_COMPLETE;
+    const key_score_t candidate = {
+      (uint8_t)key,
+      score_english_counts_bounded(&counts, bound, &stop_reason)
+    };
+
+    if (stop_reason == SCORE_STOP_BOUND) {
+      continue;
+    }
+
+    found = topk_insert_sorted(top_out, found, top_count, sizeof(*top_out),
+                               &candidate, &is_key_score_better);
+  }
+
+  assert(found <= top_count);
+  assert(found <= BYTE_VALUE_COUNT);
+
+  return found;
+}
+
+/* Score bytearray XORed with every single-byte key, as if each decryption
+ * was passed to score_english_text(), and place the results in scores_out.
+ * scores_out[key] is the score for key.
+ * None of the 256 decryptions are allocated: bytearray is counted in a single
+ * pass, and every key is scored from the permuted histogram. */
+void
+score_english_text_all_keys(const bytearray_t *bytearray,
+                            double scores_out[BYTE_VALUE_COUNT])
+{
+  assert(bytearray != NULL);
+  assert(is_bytearray_consistent(bytearray));
+  assert(scores_out != NULL);
+
+  byte_histogram_t histogram;
+  bytearray_histogram(bytearray, &histogram);
+
+  score_english_histogram_all_keys(&histogram, scores_out);
+}
+
+/* Log-Likelihood Model */
+
+
+/* Return the fixed-point log-likelihood of the length bytes at bytes being
+ * English text. Larger (less negative) values are more likely.
+ * This is a sum of table lookups, which compilers can vectorize. */
+int64_t
+score_english_log_likelihood_sum(const uint8_t *bytes, size_t length)
+{
+  assert(bytes != NULL || length == 0);
+
+  const score_model_t * const model = score_model_get(
+                                          SCORE_MODEL_ENGLISH_LOG_LIKELIHOOD);
+  const int16_t * const table = model->byte_log_likelihood;
+  int64_t sum = 0;
+
+  for (size_t i = 0; i < length; i++) {
+    sum += table[bytes[i]];
+  }
+
+  assert(sum <= 0);
+
+  return sum;
+}
+
+/* Return the fixed-point log-likelihood of the text counted in histogram,
+ * XORed with key, using the byte model table.
+ * Takes constant time, regardless of the length of the text. */
+static int64_t
+histogram_table_sum(const byte_histogram_t *histogram,
+                    const int16_t table[BYTE_VALUE_COUNT], uint8_t key)
+{
+  assert(histogram != NULL);
+  assert(table != NULL);
+
+  int64_t sum = 0;
+
+  for (size_t b = 0; b < BYTE_VALUE_COUNT; b++) {
+    sum += (int64_t)histogram->counts[b] * table[b ^ key];
+  }
+
+  assert(sum <= 0);
+
+  return sum;
+}
+
+/* Convert the fixed-point log-likelihood sum of length bytes into the mean
+ * log2 probability per byte. */
+static double
+log_likelihood_mean(int64_t sum, size_t length)
+{
+  assert(sum <= 0);
+  assert(length > 0);
+
+  return (double)sum / ((double)length * SCORE_MODEL_BIT_SCALE);
+}
+
+/* How likely is it that the text counted in histogram is English text?
+ * Returns the mean log2 probability of each byte, which is at most 0.0.
+ * Higher scores are better: English text scores around -4.6, and random
+ * bytes score around -17.
+ * histogram must not be empty. */
+double
+score_english_log_likelihood_histogram(const byte_histogram_t *histogram)
+{
+  assert(histogram != NULL);
+  assert(histogram->length > 0);
+
+  return score_histogram_model(histogram,
+                               SCORE_MODEL_ENGLISH_LOG_LIKELIHOOD);
+}
+
+/* How likely is it that bytearray is English text?
+ * Returns the mean log2 probability of each byte, like
+ * score_english_log_likelihood_histogram().
+ * bytearray must not be empty. */
+double
+score_english_log_likelihood(const bytearray_t *bytearray)
+{
+  assert(bytearray != NULL);
+  assert(is_bytearray_consistent(bytearray));
+  assert(bytearray_length(bytearray) > 0);
+
+  const size_t length = bytearray_length(bytearray);
+  const int64_t sum = score_english_log_likelihood_sum(
+                        bytearray_const_pointer_checked(bytearray, 0, length),
+                        length);
+
+  return log_likelihood_mean(sum, length);
+}
+
+/* Scoring Models */
+
+/* The n-gram model used by SCORE_MODEL_ENGLISH_NGRAM, or NULL if it hasn't
+ * been loaded */
+static ngram_model_t *score_ngram_model = NULL;
+
+/* Map the n-gram model file at path, and use it for
+ * SCORE_MODEL_ENGLISH_NGRAM. Replaces any previously loaded model.
+ * Call this at startup, before scoring with SCORE_MODEL_ENGLISH_NGRAM.
+ * Returns false if the model can't be loaded, and keeps the previous model.
+ */
+bool
+score_load_ngram_model(const char *path)
+{
+  assert(path != NULL);
+
+  ngram_model_t *model = ngram_model_load(path);
+  if (model == NULL) {
+    return false;
+  }
+
+  ngram_model_free(score_ngram_model);
+  score_ngram_model = model;
+
+  return true;
+}
+
+/* Is a model loaded for SCORE_MODEL_ENGLISH_NGRAM? */
+bool
+score_has_ngram_model(void)
+{
+  return score_ngram_model != NULL;
+}
+
+/* Score the text counted in histogram, XORed with key, using model.
+ * histogram must not be empty. */
+static double
+score_histogram_key_model(const byte_histogram_t *histogram, uint8_t key,
+                          score_model_id_t model)
+{
+  switch (model) {
+    case SCORE_MODEL_ENGLISH_HEURISTIC:
+      assert(key == 0);
+      return score_english_histogram(histogram);
+    case SCORE_MODEL_ENGLISH_LOG_LIKELIHOOD:
+    case SCORE_MODEL_FRENCH_LOG_LIKELIHOOD:
+    case SCORE_MODEL_GERMAN_LOG_LIKELIHOOD:
+    case SCORE_MODEL_SPANISH_LOG_LIKELIHOOD:
+    case SCORE_MODEL_BASE64_LOG_LIKELIHOOD:
+    case SCORE_MODEL_MARKUP_LOG_LIKELIHOOD:
+      return log_likelihood_mean(histogram_table_sum(
+                                   histogram,
+                                   score_model_get(model)->byte_log_likelihood,
+                                   key),
+                                 histogram->length);
+    case SCORE_MODEL_ENGLISH_NGRAM:
+      assert(score_ngram_model != NULL);
+      return ngram_model_score_histogram(score_ngram_model, histogram, key);
+    case SCORE_MODEL_COUNT:
+      break;
+  }
+
+  assert(false);
+  return 0.0;
+}
+
+/* Score the text counted in histogram using model.
+ * Higher scores are better, but each model has a different range.
+ * Histograms don't record byte order, so SCORE_MODEL_ENGLISH_NGRAM only uses
+ * its unigram table.
+ * histogram must not be empty. */
+double
+score_histogram_model(const byte_histogram_t *histogram,
+                      score_model_id_t model)
+{
+  assert(histogram != NULL);
+  assert(histogram->length > 0);
+
+  return score_histogram_key_model(histogram, 0, model);
+}
+
+/* Score bytearray using model, like score_histogram_model().
+ * SCORE_MODEL_ENGLISH_NGRAM uses every n-gram in bytearray.
+ * bytearray must not be empty. */
+double
+score_text_model(const bytearray_t *bytearray, score_model_id_t model)
+{
+  assert(bytearray != NULL);
+  assert(is_bytearray_consistent(bytearray));
+  assert(bytearray_length(bytearray) > 0);
+
+  if (model == SCORE_MODEL_ENGLISH_NGRAM) {
+    assert(score_ngram_model != NULL);
+
+    const size_t length = bytearray_length(bytearray);
+    return ngram_model_score_bytes(score_ngram_model,
+                                   bytearray_const_pointer_checked(bytearray,
+                                                                   0,
+                                                                   length),
+                                   length);
+  }
+
+  byte_histogram_t histogram;
+  bytearray_histogram(bytearray, &histogram);
+
+  return score_histogram_model(&histogram, model);
+}
+
+/* Score the text counted in histogram XORed with every single-byte key
+ * using model, and place the results in scores_out.
+ * scores_out[key] is the score for key.
+ * Takes constant time, regardless of the length of the text.
+ * histogram must not be empty. */
+void
+score_histogram_all_keys_model(const byte_histogram_t *histogram,
+                               score_model_id_t model,
+                               double scores_out[BYTE_VALUE_COUNT])
+{
+  assert(histogram != NULL);
+  assert(histogram->length > 0);
+  assert(scores_out != NULL);
+
+  if (model == SCORE_MODEL_ENGLISH_HEURISTIC) {
+    score_english_histogram_all_keys(histogram, scores_out);
+    return;
+  }
+
+  for (size_t key = 0; key < BYTE_VALUE_COUNT; key++) {
+    scores_out[key] = score_histogram_key_model(histogram, (uint8_t)key,
+                                                model);
+  }
+}
+
+/* Score the text counted in histogram using each of the model_count models
+ * in models, and place the results in scores_out. scores_out[i] is the
+ * score for models[i].
+ * Byte table models are all scored in a single pass over the histogram.
+ * Byte table scores can be compared with each other, so the model with the
+ * highest score is the most likely kind of text.
+ * histogram must not be empty. */
+void
+score_histogram_models(const byte_histogram_t *histogram,
+                       const score_model_id_t *models, size_t model_count,
+                       double *scores_out)
+{
+  assert(histogram != NULL);
+  assert(histogram->length > 0);
+  assert(models != NULL || model_count == 0);
+  assert(scores_out != NULL || model_count == 0);
+
+  /* The byte table models, and where their scores go */
+  const int16_t *tables[SCORE_MODEL_COUNT];
+  size_t table_models[SCORE_MODEL_COUNT];
+  int64_t sums[SCORE_MODEL_COUNT];
+  size_t table_count = 0;
+
+  for (size_t i = 0; i < model_count; i++) {
+    if (is_score_model_byte_table(models[i])
+        && table_count < SCORE_MODEL_COUNT) {
+      tables[table_count] = score_model_get(models[i])->byte_log_likelihood;
+      table_models[table_count] = i;
+      sums[table_count] = 0;
+      table_count++;
+    } else {
+      /* Other models (and repeated byte table models) score the histogram
+       * using their own code */
+      scores_out[i] = score_histogram_model(histogram, models[i]);
+    }
+  }
+
+  /* Each non-zero count is loaded once, and used by every table */
+  for (size_t b = 0; b < BYTE_VALUE_COUNT; b++) {
+    const int64_t count = (int64_t)histogram->counts[b];
+    if (count == 0) {
+      continue;
+    }
+
+    for (size_t t = 0; t < table_count; t++) {
+      sums[t] += count * tables[t][b];
+    }
+  }
+
+  for (size_t t = 0; t < table_count; t++) {
+    scores_out[table_models[t]] = log_likelihood_mean(sums[t],
+                                                      histogram->length);
+  }
+}
+
+/* Score bytearray using each of the model_count models in models, like
+ * score_histogram_models(). Only SCORE_MODEL_ENGLISH_NGRAM uses bytearray;
+ * the other models share a single histogram of bytearray.
+ * bytearray must not be empty. */
+void
+score_text_models(const bytearray_t *bytearray,
+                  const score_model_id_t *models, size_t model_count,
+                  double *scores_out)
+{
+  assert(bytearray != NULL);
+  assert(is_bytearray_consistent(bytearray));
+  assert(bytearray_length(bytearray) > 0);
+  assert(models != NULL || model_count == 0);
+  assert(scores_out != NULL || model_count == 0);
+
+  byte_histogram_t histogram;
+  bytearray_histogram(bytearray, &histogram);
+
+  score_histogram_models(&histogram, models, model_count, scores_out);
+
+  for (size_t i = 0; i < model_count; i++) {
+    if (models[i] == SCORE_MODEL_ENGLISH_NGRAM) {
+      scores_out[i] = score_text_model(bytearray, models[i]);
+    }
+  }
+}
@@ -25,9 +25,12 @@
 #include <stdbool.h>
 #include <sys/types.h>
 
+#include "char.h"
+
 /* Forward Declarations */
 
 typedef struct bytearray_t bytearray_t;
+typedef struct byte_histogram_t byte_histogram_t;
 
 /* Debugging Macros */
 
@@ -35,6 +38,64 @@ typedef struct bytearray_t bytearray_t;
 #define SCORE_DEBUG 0
 #endif
 
+/* Data Types */
+
+/* The available text scoring models */
+typedef enum score_model_id_t {
+  /* score_english_text(): between 0.0 and 1.0 */
+  SCORE_MODEL_ENGLISH_HEURISTIC,
+  /* score_english_log_likelihood(): mean log2 probability per byte, at most
+   * 0.0 */
+  SCORE_MODEL_ENGLISH_LOG_LIKELIHOOD,
+  /* score_load_ngram_model(): mean log2 probability per n-gram, at most
+   * 0.0 */
+  SCORE_MODEL_ENGLISH_NGRAM,
+  /* Byte table models, like SCORE_MODEL_ENGLISH_LOG_LIKELIHOOD (see model.h)
+   */
+  SCORE_MODEL_FRENCH_LOG_LIKELIHOOD,
+  SCORE_MODEL_GERMAN_LOG_LIKELIHOOD,
+  SCORE_MODEL_SPANISH_LOG_LIKELIHOOD,
+  /* Base64-encoded data */
+  SCORE_MODEL_BASE64_LOG_LIKELIHOOD,
+  /* JSON, HTML, and XML markup */
+  SCORE_MODEL_MARKUP_LOG_LIKELIHOOD,
+  /* The number of models */
+  SCORE_MODEL_COUNT
+} score_model_id_t;
+
+/* The number of letters in the English alphabet */
+#define LETTER_COUNT 26
+
+/* The counts used to score English text */
+typedef struct english_counts_t {
+  size_t length;
+  size_t printable;
+  size_t letter;
+  size_t space;
+  /* Case-insensitive: letter_count[0] is the number of 'a' and 'A' */
+  size_t letter_count[LETTER_COUNT];
+} english_counts_t;
+
+/* Why bounded scoring stopped */
+typedef enum score_stop_reason_t {
+  /* Every factor was evaluated, and the score is exact */
+  SCORE_STOP_COMPLETE,
+  /* Too many unprintable characters: the score is 0.0 */
+  SCORE_STOP_UNPRINTABLE,
+  /* Too many non-letter characters: the score is 0.0 */
+  SCORE_STOP_NONLETTER,
+  /* The space frequency is too far from English: the score is 0.0 */
+  SCORE_STOP_SPACE,
+  /* The score can't reach the bound */
+  SCORE_STOP_BOUND
+} score_stop_reason_t;
+
+/* A single-byte XOR key, and the score of the text decrypted with it */
+typedef struct key_score_t {
+  uint8_t key;
+  double score;
+} key_score_t;
+
 /* Function Declarations */
 
 bool is_byte_ascii_printable(uint8_t byte);
@@ -61,7 +122,54 @@ size_t count_byte(const bytearray_t *bytearray, uint8_t byte);
 #define count_nonbyte(b, byte) \
                                (bytearray_length(b) - count_byte(b, byte))
 
+void english_counts_clear(english_counts_t *counts);
+void english_counts_add_byte(english_counts_t *counts, uint8_t byte);
+void english_counts_remove_byte(english_counts_t *counts, uint8_t byte);
+double score_english_class_counts_bounded(const english_counts_t *counts,
+                                          double bound,
+                                          score_stop_reason_t *stop_reason_out);
+double score_english_counts_bounded(const english_counts_t *counts,
+                                    double bound,
+                                    score_stop_reason_t *stop_reason_out);
+
 double score_english_letter_frequency(const bytearray_t *bytearray);
+double score_english_histogram(const byte_histogram_t *histogram);
 double score_english_text(const bytearray_t *bytearray);
+double score_english_text_bounded(const bytearray_t *bytearray, double bound,
+                                  score_stop_reason_t *stop_reason_out);
+
+void score_english_histogram_all_keys(const byte_histogram_t *histogram,
+                                      double scores_out[BYTE_VALUE_COUNT]);
+void score_english_histogram_all_keys_bounded(
+                                        const byte_histogram_t *histogram,
+                                        double bound,
+                                        double scores_out[BYTE_VALUE_COUNT]);
+bool is_key_score_better(const void *key_score, const void *other);
+size_t score_english_histogram_top_keys(const byte_histogram_t *histogram,
+                                        key_score_t *top_out,
+                                        size_t top_count);
+void score_english_text_all_keys(const bytearray_t *bytearray,
+                                 double scores_out[BYTE_VALUE_COUNT]);
+
+int64_t score_english_log_likelihood_sum(const uint8_t *bytes, size_t length);
+double score_english_log_likelihood_histogram(
+                                        const byte_histogram_t *histogram);
+double score_english_log_likelihood(const bytearray_t *bytearray);
+
+bool score_load_ngram_model(const char *path);
+bool score_has_ngram_model(void);
+
+double score_histogram_model(const byte_histogram_t *histogram,
+                             score_model_id_t model);
+double score_text_model(const bytearray_t *bytearray, score_model_id_t model);
+void score_histogram_all_keys_model(const byte_histogram_t *histogram,
+                                    score_model_id_t model,
+                                    double scores_out[BYTE_VALUE_COUNT]);
+void score_histogram_models(const byte_histogram_t *histogram,
+                            const score_model_id_t *models,
+                            size_t model_count, double *scores_out);
+void score_text_models(const bytearray_t *bytearray,
+                       const score_model_id_t *models, size_t model_count,
+                       double *scores_out);
 
 #endif /* score_h */
@@ -0,0 +1,285 @@
+//
+//  topk.c
+//  MatasanoCrypto
+//
+//  Created by Tim Wilson-Brown on 18/10/2026.
+//  Copyright © 2026 teor - gmail: teor2345
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "topk.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Allocate and return a new, empty top-k collector, which keeps the best
+ * capacity entries.
+ * The caller must free the collector using topk_free(). */
+topk_t *
+topk_alloc(size_t capacity)
+{
+  assert(capacity > 0);
+
+  topk_t *topk = malloc(sizeof(*topk));
+  assert(topk != NULL);
+
+  topk->capacity = capacity;
+  topk->count = 0;
+  topk->entries = calloc(capacity, sizeof(*topk->entries));
+  assert(topk->entries != NULL);
+
+  return topk;
+}
+
+/* Free topk, which was allocated by topk_alloc().
+ * Use the topk_free() macro, which also sets topk to NULL. */
+void
+topk_free_(topk_t *topk)
+{
+  if (topk == NULL) {
+    return;
+  }
+
+  free(topk->entries);
+  free(topk);
+}
+
+/* Is entry better than other?
+ * Higher scores are better. Ties are broken by lower lines, then lower keys,
+ * so the order is deterministic. */
+bool
+is_topk_entry_better(const topk_entry_t *entry, const topk_entry_t *other)
+{
+  assert(entry != NULL);
+  assert(other != NULL);
+
+  if (entry->score != other->score) {
+    return entry->score > other->score;
+  } else if (entry->line != other->line) {
+    return entry->line < other->line;
+  } else {
+    return entry->key < other->key;
+  }
+}
+
+/* Swap the entries at indexes i and j in topk. */
+static void
+topk_swap(topk_t *topk, size_t i, size_t j)
+{
+  const topk_entry_t entry = topk->entries[i];
+  topk->entries[i] = topk->entries[j];
+  topk->entries[j] = entry;
+}
+
+/* Move the entry at index down the heap until its children are better. */
+static void
+topk_sift_down(topk_t *topk, size_t index)
+{
+  while (1) {
+    const size_t left = 2 * index + 1;
+    const size_t right = left + 1;
+    size_t worst = index;
+
+    if (left < topk->count
+        && is_topk_entry_better(&topk->entries[worst],
+                                &topk->entries[left])) {
+      worst = left;
+    }
+    if (right < topk->count
+        && is_topk_entry_better(&topk->entries[worst],
+                                &topk->entries[right])) {
+      worst = right;
+    }
+
+    if (worst == index) {
+      return;
+    }
+
+    topk_swap(topk, index, worst);
+    index = worst;
+  }
+}
+
+/* Move the entry at index up the heap until its parent is worse. */
+static void
+topk_sift_up(topk_t *topk, size_t index)
+{
+  while (index > 0) {
+    const size_t parent = (index - 1) / 2;
+
+    if (!is_topk_entry_better(&topk->entries[parent],
+                              &topk->entries[index])) {
+      return;
+    }
+
+    topk_swap(topk, index, parent);
+    index = parent;
+  }
+}
+
+/* Offer the candidate (line, key, score) to topk.
+ * Returns true if it is kept, because topk isn't full, or it is better than
+ * the worst kept entry (which is then discarded).
+ * Takes O(log capacity) time. */
+bool
+topk_offer(topk_t *topk, size_t line, uint8_t key, double score)
+{
+  assert(topk != NULL);
+  assert(topk->count <= topk->capacity);
+
+  topk_entry_t entry;
+  memset(&entry, 0, sizeof(entry));
+  entry.line = line;
+  entry.key = key;
+  entry.score = score;
+
+  if (topk->count < topk->capacity) {
+    topk->entries[topk->count] = entry;
+    topk->count++;
+    topk_sift_up(topk, topk->count - 1);
+    return true;
+  }
+
+  if (!is_topk_entry_better(&entry, &topk->entries[0])) {
+    return false;
+  }
+
+  topk->entries[0] = entry;
+  topk_sift_down(topk, 0);
+  return true;
+}
+
+/* Return the lowest score that could be kept by topk: the worst kept score
+ * when topk is full, and -INFINITY otherwise.
+ * Use this as the bound for bounded scoring. */
+double
+topk_min_score(const topk_t *topk)
+{
+  assert(topk != NULL);
+
+  if (topk->count < topk->capacity) {
+    return -INFINITY;
+  }
+
+  return topk->entries[0].score;
+}
+
+/* Offer every entry in other to topk.
+ * Use this to merge per-thread collectors after a parallel search. The
+ * result is the same whatever order the collectors are merged in. */
+void
+topk_merge(topk_t *topk, const topk_t *other)
+{
+  assert(topk != NULL);
+  assert(other != NULL);
+  assert(topk != other);
+
+  for (size_t i = 0; i < other->count; i++) {
+    topk_offer(topk, other->entries[i].line, other->entries[i].key,
+               other->entries[i].score);
+  }
+}
+
+/* Compare entries for qsort(), best first. */
+static int
+compare_topk_entries(const void *a, const void *b)
+{
+  const topk_entry_t *entry_a = a;
+  const topk_entry_t *entry_b = b;
+
+  if (is_topk_entry_better(entry_a, entry_b)) {
+    return -1;
+  } else if (is_topk_entry_better(entry_b, entry_a)) {
+    return 1;
+  } else {
+    return 0;
+  }
+}
+
+/* Place up to entries_out_count of the entries kept by topk in
+ * entries_out, best first.
+ * Returns the number of entries placed in entries_out. */
+size_t
+topk_sorted(const topk_t *topk, topk_entry_t *entries_out,
+            size_t entries_out_count)
+{
+  assert(topk != NULL);
+  assert(entries_out != NULL || entries_out_count == 0);
+
+  topk_entry_t *sorted = calloc(topk->capacity, sizeof(*sorted));
+  assert(sorted != NULL);
+
+  memcpy(sorted, topk->entries, topk->count * sizeof(*sorted));
+  qsort(sorted, topk->count, sizeof(*sorted), &compare_topk_entries);
+
+  const size_t result = (topk->count < entries_out_count
+                         ? topk->count
+                         : entries_out_count);
+  if (result > 0) {
+    memcpy(entries_out, sorted, result * sizeof(*sorted));
+  }
+
+  free(sorted);
+
+  return result;
+}
+
+/* Sorted Arrays */
+
+/* Insert item into the count items in items, which are sorted best first
+ * by is_better, and hold up to capacity items of item_size bytes each.
+ * If items is full, item replaces the worst item, but only if it is better.
+ * Equal items keep the order they were inserted in.
+ * Returns the new number of items.
+ * This is faster than a topk_t for a handful of items that must always be
+ * in order. */
+size_t
+topk_insert_sorted(void *items, size_t count, size_t capacity,
+                   size_t item_size, const void *item,
+                   topk_better_func is_better)
+{
+  assert(items != NULL || capacity == 0);
+  assert(count <= capacity);
+  assert(item_size > 0);
+  assert(item != NULL);
+  assert(is_better != NULL);
+
+  uint8_t * const bytes = items;
+
+  /* The slot that is freed up by the shift: a new slot, or the worst item */
+  size_t end = count;
+  if (count == capacity) {
+    if (count == 0 || !is_better(item, &bytes[(count - 1) * item_size])) {
+      return count;
+    }
+    end = count - 1;
+  } else {
+    count++;
+  }
+
+  size_t pos = end;
+  while (pos > 0 && is_better(item, &bytes[(pos - 1) * item_size])) {
+    pos--;
+  }
+
+  memmove(&bytes[(pos + 1) * item_size], &bytes[pos * item_size],
+          (end - pos) * item_size);
+  memcpy(&bytes[pos * item_size], item, item_size);
+
+  assert(count <= capacity);
+  return count;
+}
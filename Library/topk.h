@@ -0,0 +1,76 @@
+//
+//  topk.h
+//  MatasanoCrypto
+//
+//  Created by Tim Wilson-Brown on 18/10/2026.
+//  Copyright © 2026 teor - gmail: teor2345
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef topk_h
+#define topk_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/* Data Types */
+
+/* A single candidate decryption: the input line it came from, the key, and
+ * its score. Higher scores are better. */
+typedef struct topk_entry_t {
+  size_t line;
+  uint8_t key;
+  double score;
+} topk_entry_t;
+
+/* Keeps the capacity best entries offered to it.
+ * Entries are ordered by score, then line, then key, so the kept entries
+ * don't depend on the order they were offered in. */
+typedef struct topk_t {
+  size_t capacity;
+  size_t count;
+  /* A binary min-heap: the worst kept entry is entries[0] */
+  topk_entry_t *entries;
+} topk_t;
+
+/* Is item better than other? Used to keep small sorted arrays of any item
+ * type in topk_insert_sorted(). */
+typedef bool (*topk_better_func)(const void *item, const void *other);
+
+/* Function Declarations */
+
+topk_t *topk_alloc(size_t capacity);
+void topk_free_(topk_t *topk);
+#define topk_free(topk) \
+  do { \
+    topk_free_(topk); \
+    topk = NULL; \
+  } while (0)
+
+bool is_topk_entry_better(const topk_entry_t *entry,
+                          const topk_entry_t *other);
+
+bool topk_offer(topk_t *topk, size_t line, uint8_t key, double score);
+double topk_min_score(const topk_t *topk);
+void topk_merge(topk_t *topk, const topk_t *other);
+size_t topk_sorted(const topk_t *topk, topk_entry_t *entries_out,
+                   size_t entries_out_count);
+
+size_t topk_insert_sorted(void *items, size_t count, size_t capacity,
+                          size_t item_size, const void *item,
+                          topk_better_func is_better);
+
+#endif /* topk_h */
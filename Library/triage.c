@@ -0,0 +1,212 @@
+//
+//  triage.c
+//  MatasanoCrypto
+//
+//  Created by Tim Wilson-Brown on 18/10/2026.
+//  Copyright © 2026 teor - gmail: teor2345
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "triage.h"
+
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+
+#include "char.h"
+#include "histogram.h"
+#include "score.h"
+
+/* Triage Thresholds */
+
+/* Text is almost all printable: this allows for a newline every 20
+ * characters, like the English scoring heuristic */
+#define TRIAGE_TEXT_MIN_RATIO 0.95
+
+/* Random data uses almost as many distinct byte values as expected: data
+ * with fewer distinct values than this many standard deviations below the
+ * expected count isn't random. */
+#define TRIAGE_RANDOM_DISTINCT_DEVIATIONS 4.0
+
+/* Text uses at most a few dozen distinct values, and so does XORed text,
+ * because XOR only permutes the byte values. But in short data, text and
+ * random bytes both have mostly distinct values, so the distinct count
+ * can't tell them apart.
+ * In 48 random bytes, we expect 43.9 distinct values, with a standard
+ * deviation of 1.8, so random data has at least 36.6. 48 bytes of English
+ * text use at most around 32. In 30 bytes, random data has at least 23.6,
+ * and English text can have 25. */
+#define TRIAGE_DISTINCT_MIN_LENGTH 48
+
+/* The chi-squared statistic is only meaningful when each byte value is
+ * expected at least this many times */
+#define TRIAGE_CHI_SQUARED_MIN_EXPECTED 5
+
+/* The chi-squared statistic for uniform bytes has 255 degrees of freedom:
+ * a mean of 255, and a standard deviation of 22.6. Data more than 4
+ * standard deviations above the mean isn't uniform. */
+#define TRIAGE_RANDOM_MAX_CHI_SQUARED (255.0 + 4.0*22.6)
+
+/* Compressed data has high entropy, but its bytes aren't quite uniform */
+#define TRIAGE_COMPRESSED_MIN_ENTROPY 7.0
+
+/* Classification */
+
+/* Is byte printable, or a tab, newline, or carriage return? */
+static bool
+is_byte_triage_text(uint8_t byte)
+{
+  return (is_byte_ascii_printable(byte)
+          || byte == '\t' || byte == '\n' || byte == '\r');
+}
+
+/* Return the expected number of distinct byte values in length uniformly
+ * random bytes. */
+static double
+random_distinct_count(size_t length)
+{
+  const double miss = 1.0 - 1.0/BYTE_VALUE_COUNT;
+  return BYTE_VALUE_COUNT * (1.0 - pow(miss, (double)length));
+}
+
+/* Return the standard deviation of the number of distinct byte values in
+ * length uniformly random bytes. */
+static double
+random_distinct_deviation(size_t length)
+{
+  const double values = BYTE_VALUE_COUNT;
+  const double miss = pow(1.0 - 1.0/values, (double)length);
+  const double miss_both = pow(1.0 - 2.0/values, (double)length);
+
+  /* The variance of the number of byte values that don't appear */
+  const double variance = (values * (values - 1.0) * miss_both
+                           + values * miss
+                           - values * values * miss * miss);
+
+  return sqrt(fmax(variance, 0.0));
+}
+
+/* Calculate the triage statistics for the data counted in histogram, and
+ * classify it. Places the results in triage_out.
+ * Makes one pass over the histogram, so it takes constant time, regardless
+ * of the length of the data.
+ * Short random data and compressed data look the same, so compressed data
+ * is only detected when there are enough bytes for a chi-squared test.
+ * Random data is only detected when there are enough bytes to tell it apart
+ * from text. Shorter data is classified as XORed text, so it is searched.
+ * histogram must not be empty. */
+void
+triage_histogram(const byte_histogram_t *histogram, triage_t *triage_out)
+{
+  assert(histogram != NULL);
+  assert(histogram->length > 0);
+  assert(triage_out != NULL);
+
+  const double length = (double)histogram->length;
+  const double expected = length / BYTE_VALUE_COUNT;
+
+  double entropy = 0.0;
+  double chi_squared = 0.0;
+  size_t distinct = 0;
+  size_t text = 0;
+
+  for (size_t b = 0; b < BYTE_VALUE_COUNT; b++) {
+    const size_t count = histogram->counts[b];
+    const double deviation = (double)count - expected;
+    chi_squared += deviation * deviation / expected;
+
+    if (count == 0) {
+      continue;
+    }
+
+    const double p = (double)count / length;
+    entropy -= p * log2(p);
+    distinct++;
+
+    if (is_byte_triage_text((uint8_t)b)) {
+      text += count;
+    }
+  }
+
+  triage_out->entropy = entropy;
+  triage_out->distinct = distinct;
+  triage_out->random_distinct = random_distinct_count(histogram->length);
+  triage_out->text_ratio = (double)text / length;
+  triage_out->chi_squared = chi_squared;
+
+  const double distinct_ratio = ((double)distinct
+                                 / triage_out->random_distinct);
+  const bool can_test_uniform = (expected
+                                 >= TRIAGE_CHI_SQUARED_MIN_EXPECTED);
+  const bool can_test_distinct = (histogram->length
+                                  >= TRIAGE_DISTINCT_MIN_LENGTH);
+  const double random_min_distinct = (triage_out->random_distinct
+                                      - TRIAGE_RANDOM_DISTINCT_DEVIATIONS
+                                        * random_distinct_deviation(
+                                                  histogram->length));
+
+  /* Repeated values make the distinct ratio smaller, so data with fewer
+   * distinct values is more promising */
+  triage_out->promise = fmax(0.0, 1.0 - distinct_ratio);
+
+  if (triage_out->text_ratio >= TRIAGE_TEXT_MIN_RATIO) {
+    triage_out->triage_class = TRIAGE_TEXT;
+  } else if (can_test_uniform
+             && chi_squared > TRIAGE_RANDOM_MAX_CHI_SQUARED
+             && entropy >= TRIAGE_COMPRESSED_MIN_ENTROPY) {
+    triage_out->triage_class = TRIAGE_COMPRESSED;
+  } else if (can_test_distinct
+             && (double)distinct >= random_min_distinct
+             && (!can_test_uniform
+                 || chi_squared <= TRIAGE_RANDOM_MAX_CHI_SQUARED)) {
+    triage_out->triage_class = TRIAGE_RANDOM;
+  } else {
+    triage_out->triage_class = TRIAGE_XOR_TEXT;
+  }
+
+  assert(triage_out->entropy >= 0.0);
+  assert(triage_out->entropy <= 8.0 + DBL_EPSILON*8);
+  assert(triage_out->promise >= 0.0);
+  assert(triage_out->promise <= 1.0);
+}
+
+/* Could the data classified in triage be text, or XORed text? */
+bool
+is_triage_searchable(const triage_t *triage)
+{
+  assert(triage != NULL);
+
+  return (triage->triage_class == TRIAGE_TEXT
+          || triage->triage_class == TRIAGE_XOR_TEXT);
+}
+
+/* Return a static string describing triage_class. */
+const char *
+triage_class_name(triage_class_t triage_class)
+{
+  switch (triage_class) {
+    case TRIAGE_RANDOM:
+      return "random";
+    case TRIAGE_COMPRESSED:
+      return "compressed";
+    case TRIAGE_XOR_TEXT:
+      return "xor-text";
+    case TRIAGE_TEXT:
+      return "text";
+  }
+
+  assert(false);
+  return "unknown";
+}
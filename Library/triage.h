@@ -0,0 +1,73 @@
+//
+//  triage.h
+//  MatasanoCrypto
+//
+//  Created by Tim Wilson-Brown on 18/10/2026.
+//  Copyright © 2026 teor - gmail: teor2345
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef triage_h
+#define triage_h
+
+#include <stdbool.h>
+#include <sys/types.h>
+
+/* Forward Declarations */
+
+typedef struct byte_histogram_t byte_histogram_t;
+
+/* Data Types */
+
+/* What kind of data a buffer looks like */
+typedef enum triage_class_t {
+  /* Uniformly distributed bytes, like ciphertext or keys */
+  TRIAGE_RANDOM,
+  /* High entropy, but not uniform enough to be random */
+  TRIAGE_COMPRESSED,
+  /* Few distinct byte values, but not text: possibly XORed text */
+  TRIAGE_XOR_TEXT,
+  /* Mostly printable text */
+  TRIAGE_TEXT
+} triage_class_t;
+
+/* The statistics used to classify a buffer, and the result */
+typedef struct triage_t {
+  triage_class_t triage_class;
+  /* The Shannon entropy, in bits per byte */
+  double entropy;
+  /* The number of distinct byte values */
+  size_t distinct;
+  /* The expected number of distinct byte values in random data of the same
+   * length */
+  double random_distinct;
+  /* The fraction of bytes that are printable, tab, newline, or carriage
+   * return */
+  double text_ratio;
+  /* The chi-squared statistic against uniformly distributed bytes */
+  double chi_squared;
+  /* How likely the buffer is to be text or XORed text, between 0.0 and 1.0.
+   * Higher values are more promising. */
+  double promise;
+} triage_t;
+
+/* Function Declarations */
+
+void triage_histogram(const byte_histogram_t *histogram,
+                      triage_t *triage_out);
+bool is_triage_searchable(const triage_t *triage);
+const char *triage_class_name(triage_class_t triage_class);
+
+#endif /* triage_h */
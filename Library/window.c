@@ -0,0 +1,195 @@
+//
+//  window.c
+//  MatasanoCrypto
+//
+//  Created by Tim Wilson-Brown on 18/10/2026.
+//  Copyright © 2026 teor - gmail: teor2345
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "window.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Private Data Types */
+
+/* A sliding window over a stream of bytes, with the counts used to score
+ * the bytes in the window */
+struct score_window_t {
+  size_t window_length;
+  /* The total number of bytes pushed */
+  size_t pushed;
+  /* The last window_length bytes pushed, indexed by pushed % window_length
+   */
+  uint8_t *ring;
+  english_counts_t counts;
+};
+
+/* Allocate and return a new, empty sliding window of window_length bytes.
+ * The caller must free the window using score_window_free(). */
+score_window_t *
+score_window_alloc(size_t window_length)
+{
+  assert(window_length > 0);
+
+  score_window_t *window = malloc(sizeof(*window));
+  assert(window != NULL);
+
+  window->window_length = window_length;
+  window->pushed = 0;
+  window->ring = calloc(window_length, sizeof(*window->ring));
+  assert(window->ring != NULL);
+  english_counts_clear(&window->counts);
+
+  return window;
+}
+
+/* Free window, which was allocated by score_window_alloc().
+ * Use the score_window_free() macro, which also sets window to NULL. */
+void
+score_window_free_(score_window_t *window)
+{
+  if (window == NULL) {
+    return;
+  }
+
+  free(window->ring);
+  free(window);
+}
+
+/* Push byte into window. If the window is full, the oldest byte slides out.
+ * Takes constant time, regardless of the window length. */
+void
+score_window_push(score_window_t *window, uint8_t byte)
+{
+  assert(window != NULL);
+
+  const size_t slot = window->pushed % window->window_length;
+
+  if (score_window_is_full(window)) {
+    english_counts_remove_byte(&window->counts, window->ring[slot]);
+  }
+
+  window->ring[slot] = byte;
+  english_counts_add_byte(&window->counts, byte);
+  window->pushed++;
+
+  assert(window->counts.length <= window->window_length);
+}
+
+/* Does window hold window_length bytes? */
+bool
+score_window_is_full(const score_window_t *window)
+{
+  assert(window != NULL);
+
+  return window->pushed >= window->window_length;
+}
+
+/* Return the stream offset of the first byte in window. */
+size_t
+score_window_offset(const score_window_t *window)
+{
+  assert(window != NULL);
+
+  return window->pushed - window->counts.length;
+}
+
+/* Score the bytes in window, like score_english_text_bounded().
+ * Takes constant time, regardless of the window length.
+ * window must not be empty. */
+double
+score_window_score(const score_window_t *window, double bound,
+                   score_stop_reason_t *stop_reason_out)
+{
+  assert(window != NULL);
+  assert(window->counts.length > 0);
+
+  return score_english_counts_bounded(&window->counts, bound,
+                                      stop_reason_out);
+}
+
+/* Score every window of window_length bytes in the length bytes at bytes,
+ * and call report for each region of overlapping windows that score at
+ * least threshold. Regions are reported in order.
+ * Each byte is added to and removed from the window counts once, so this
+ * takes time proportional to length, regardless of window_length. Windows
+ * that can't reach threshold stop scoring early.
+ * Returns the number of regions reported. */
+size_t
+score_window_scan(const uint8_t *bytes, size_t length, size_t window_length,
+                  double threshold, score_region_func report, void *context)
+{
+  assert(bytes != NULL || length == 0);
+  assert(window_length > 0);
+  assert(report != NULL);
+
+  if (length < window_length) {
+    return 0;
+  }
+
+  english_counts_t counts;
+  english_counts_clear(&counts);
+
+  for (size_t i = 0; i < window_length; i++) {
+    english_counts_add_byte(&counts, bytes[i]);
+  }
+
+  size_t region_count = 0;
+  bool in_region = false;
+  score_region_t region;
+  memset(&region, 0, sizeof(region));
+
+  /* The window starting at offset */
+  for (size_t offset = 0; offset + window_length <= length; offset++) {
+    if (offset > 0) {
+      english_counts_remove_byte(&counts, bytes[offset - 1]);
+      english_counts_add_byte(&counts, bytes[offset + window_length - 1]);
+    }
+
+    score_stop_reason_t stop_reason = SCORE_STOP_COMPLETE;
+    const double score = score_english_counts_bounded(&counts, threshold,
+                                                      &stop_reason);
+    const bool is_match = (stop_reason == SCORE_STOP_COMPLETE
+                           && score >= threshold);
+
+    if (is_match && !in_region) {
+      in_region = true;
+      region.offset = offset;
+      region.best_offset = offset;
+      region.best_score = score;
+    } else if (is_match && score > region.best_score) {
+      region.best_offset = offset;
+      region.best_score = score;
+    }
+
+    if (is_match) {
+      region.length = offset + window_length - region.offset;
+    } else if (in_region) {
+      report(&region, context);
+      region_count++;
+      in_region = false;
+    }
+  }
+
+  if (in_region) {
+    report(&region, context);
+    region_count++;
+  }
+
+  return region_count;
+}
@@ -0,0 +1,71 @@
+//
+//  window.h
+//  MatasanoCrypto
+//
+//  Created by Tim Wilson-Brown on 18/10/2026.
+//  Copyright © 2026 teor - gmail: teor2345
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef window_h
+#define window_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "score.h"
+
+/* Forward Declarations */
+
+typedef struct score_window_t score_window_t;
+
+/* Data Types */
+
+/* A region of consecutive windows that all scored at least the threshold.
+ * The region covers every byte in those windows. */
+typedef struct score_region_t {
+  size_t offset;
+  size_t length;
+  /* The best window in the region */
+  size_t best_offset;
+  double best_score;
+} score_region_t;
+
+/* Called for each region found by score_window_scan() */
+typedef void (*score_region_func)(const score_region_t *region,
+                                  void *context);
+
+/* Function Declarations */
+
+score_window_t *score_window_alloc(size_t window_length);
+void score_window_free_(score_window_t *window);
+#define score_window_free(window) \
+  do { \
+    score_window_free_(window); \
+    window = NULL; \
+  } while (0)
+
+void score_window_push(score_window_t *window, uint8_t byte);
+bool score_window_is_full(const score_window_t *window);
+size_t score_window_offset(const score_window_t *window);
+double score_window_score(const score_window_t *window, double bound,
+                          score_stop_reason_t *stop_reason_out);
+
+size_t score_window_scan(const uint8_t *bytes, size_t length,
+                         size_t window_length, double threshold,
+                         score_region_func report, void *context);
+
+#endif /* window_h */
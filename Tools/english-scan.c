@@ -0,0 +1,169 @@
+//
+//  english-scan
+//  Find regions of English text in large files
+//  MatasanoCrypto
+//
+//  Created by Tim Wilson-Brown on 18/10/2026.
+//  Copyright © 2026 teor - gmail: teor2345
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <assert.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "bytearray.h"
+#include "score.h"
+#include "window.h"
+
+/* Tool-Specific Constants */
+
+#define USAGE "usage: english-scan [-w window-length] [-t threshold] " \
+              "file...\n" \
+              "Writes a tab-separated table of English regions to " \
+              "standard output.\n"
+
+/* Windows shorter than a sentence or two have noisy scores */
+#define DEFAULT_WINDOW_LENGTH 64
+#define DEFAULT_THRESHOLD 0.3
+
+/* Data Types */
+
+/* The file being scanned, passed to print_region() */
+typedef struct scan_file_t {
+  const char *path;
+  const uint8_t *bytes;
+  size_t window_length;
+} scan_file_t;
+
+/* Implementation */
+
+/* Print region, which was found in the scan_file_t context, as a table row.
+ * The best window is printed with unprintable bytes escaped.
+ * A score_region_func. */
+static void
+print_region(const score_region_t *region, void *context)
+{
+  const scan_file_t *file = context;
+  assert(region != NULL);
+  assert(file != NULL);
+
+  bytearray_t *best_window = bytes_to_bytearray(
+                                           &file->bytes[region->best_offset],
+                                           file->window_length);
+  char *best_escstr = bytearray_to_escstr(best_window);
+
+  printf("%s\t%zu\t%zu\t%zu\t%.3f\t%s\n", file->path, region->offset,
+         region->length, region->best_offset, region->best_score,
+         best_escstr);
+
+  free(best_escstr);
+  bytearray_free(best_window);
+}
+
+/* Map the file at path, and print every region of windows of window_length
+ * bytes that score at least threshold.
+ * Returns false if the file can't be opened or mapped. */
+static bool
+scan_file(const char *path, size_t window_length, double threshold)
+{
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < 0) {
+    close(fd);
+    return false;
+  }
+
+  /* Empty files can't be mapped, but they don't have any windows */
+  if (st.st_size == 0) {
+    close(fd);
+    return true;
+  }
+
+  const size_t length = (size_t)st.st_size;
+  void *mapping = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+
+  if (mapping == MAP_FAILED) {
+    return false;
+  }
+
+  /* Each byte is read once, in order */
+  (void)madvise(mapping, length, MADV_SEQUENTIAL);
+
+  scan_file_t file;
+  file.path = path;
+  file.bytes = mapping;
+  file.window_length = window_length;
+
+  score_window_scan(file.bytes, length, window_length, threshold,
+                    &print_region, &file);
+
+  int rv = munmap(mapping, length);
+  assert(rv == 0);
+
+  return true;
+}
+
+int
+main(int argc, const char * argv[])
+{
+  size_t window_length = DEFAULT_WINDOW_LENGTH;
+  double threshold = DEFAULT_THRESHOLD;
+  int first_file = 1;
+
+  while (first_file + 1 < argc && argv[first_file][0] == '-') {
+    const char *option = argv[first_file];
+    const char *value = argv[first_file + 1];
+
+    if (strcmp(option, "-w") == 0) {
+      window_length = strtoul(value, NULL, 10);
+    } else if (strcmp(option, "-t") == 0) {
+      threshold = strtod(value, NULL);
+    } else {
+      break;
+    }
+
+    first_file += 2;
+  }
+
+  if (first_file >= argc || window_length == 0) {
+    fprintf(stderr, USAGE);
+    return 1;
+  }
+
+  printf("file\tregion_offset\tregion_length\tbest_offset\tbest_score"
+         "\tbest_window\n");
+
+  for (int i = first_file; i < argc; i++) {
+    if (!scan_file(argv[i], window_length, threshold)) {
+      fprintf(stderr, "Can't read file: %s\n", argv[i]);
+      return 1;
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,112 @@
+//
+//  ngram-train
+//  Train an n-gram English model from a text corpus
+//  MatasanoCrypto
+//
+//  Created by Tim Wilson-Brown on 18/10/2026.
+//  Copyright © 2026 teor - gmail: teor2345
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ngram.h"
+
+/* Tool-Specific Constants */
+
+#define USAGE "usage: ngram-train [-o model-path] corpus-file...\n" \
+              "Writes " NGRAM_MODEL_DEFAULT_PATH " by default.\n"
+
+/* Implementation */
+
+/* Count the n-grams in the file at path, and add them to counts.
+ * Returns the number of bytes counted, or -1 if the file can't be read. */
+static long
+count_file(ngram_counts_t *counts, const char *path)
+{
+  FILE *f = fopen(path, "rb");
+  if (f == NULL) {
+    return -1;
+  }
+
+  /* Read the whole file, so n-grams aren't split between reads */
+  long length = -1;
+  if (fseek(f, 0, SEEK_END) == 0) {
+    length = ftell(f);
+  }
+  if (length < 0 || fseek(f, 0, SEEK_SET) != 0) {
+    fclose(f);
+    return -1;
+  }
+
+  uint8_t *bytes = malloc(length > 0 ? (size_t)length : 1);
+  assert(bytes != NULL);
+
+  if (fread(bytes, 1, (size_t)length, f) != (size_t)length) {
+    length = -1;
+  } else {
+    ngram_counts_add_text(counts, bytes, (size_t)length);
+  }
+
+  free(bytes);
+  fclose(f);
+
+  return length;
+}
+
+int
+main(int argc, const char * argv[])
+{
+  const char *model_path = NGRAM_MODEL_DEFAULT_PATH;
+  int first_corpus = 1;
+
+  if (argc >= 3 && argv[1][0] == '-' && argv[1][1] == 'o'
+      && argv[1][2] == 0) {
+    model_path = argv[2];
+    first_corpus = 3;
+  }
+
+  if (first_corpus >= argc) {
+    fprintf(stderr, USAGE);
+    return 1;
+  }
+
+  ngram_counts_t *counts = ngram_counts_alloc();
+
+  for (int i = first_corpus; i < argc; i++) {
+    long length = count_file(counts, argv[i]);
+    if (length < 0) {
+      fprintf(stderr, "Can't read corpus file: %s\n", argv[i]);
+      ngram_counts_free(counts);
+      return 1;
+    }
+    printf("Corpus:                %s (%ld bytes)\n", argv[i], length);
+  }
+
+  if (!ngram_model_write(counts, model_path)) {
+    fprintf(stderr, "Can't write model file: %s\n", model_path);
+    ngram_counts_free(counts);
+    return 1;
+  }
+
+  printf("Model:                 %s (%llu corpus bytes)\n", model_path,
+         (unsigned long long)counts->length);
+
+  ngram_counts_free(counts);
+
+  return 0;
+}
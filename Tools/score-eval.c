@@ -0,0 +1,425 @@
+//
+//  score-eval
+//  Measure the accuracy and throughput of the text scoring models
+//  MatasanoCrypto
+//
+//  Created by Tim Wilson-Brown on 18/10/2026.
+//  Copyright © 2026 teor - gmail: teor2345
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bit_ops.h"
+#include "bytearray.h"
+#include "char.h"
+#include "histogram.h"
+#include "model.h"
+#include "ngram.h"
+#include "score.h"
+
+/* Tool-Specific Constants */
+
+#define USAGE "usage: score-eval [-n samples] [-s seed] corpus-file...\n" \
+              "Writes a tab-separated table to standard output.\n" \
+              "Uses " NGRAM_MODEL_DEFAULT_PATH " if it exists.\n"
+
+/* The default number of English samples. There are as many decoys, half
+ * random and half binary. */
+#define DEFAULT_SAMPLE_COUNT 2000
+#define DEFAULT_SEED 1
+
+/* Sample lengths are chosen uniformly from this range */
+#define MIN_SAMPLE_LENGTH 20
+#define MAX_SAMPLE_LENGTH 80
+
+/* The thresholds reported for each model */
+#define THRESHOLD_COUNT 4
+static const double heuristic_thresholds[THRESHOLD_COUNT] = {
+  0.05, 0.1, 0.2, 0.3
+};
+/* Mean log2 probability per byte */
+static const double log_likelihood_thresholds[THRESHOLD_COUNT] = {
+  -8.0, -7.0, -6.0, -5.0
+};
+/* Mean log2 probability per n-gram. Trigrams predict English better than
+ * bytes do, so English scores higher. */
+static const double ngram_thresholds[THRESHOLD_COUNT] = {
+  -6.0, -5.5, -5.0, -4.5
+};
+
+/* Data Types */
+
+/* The kinds of sample in the dataset */
+typedef enum sample_kind_t {
+  /* English text, XORed with a single-byte key */
+  SAMPLE_ENGLISH,
+  /* Uniformly random bytes */
+  SAMPLE_RANDOM,
+  /* Binary data, mostly zeroes and small integers */
+  SAMPLE_BINARY
+} sample_kind_t;
+
+/* A labeled sample */
+typedef struct sample_t {
+  sample_kind_t kind;
+  /* The key used to encrypt English samples */
+  uint8_t key;
+  uint8_t *bytes;
+  size_t length;
+} sample_t;
+
+/* The best key a model found for a sample, and its score */
+typedef struct sample_result_t {
+  uint8_t key;
+  double score;
+} sample_result_t;
+
+/* Implementation */
+
+/* Random Numbers */
+
+/* Return the next pseudo-random number from state, using xorshift64*.
+ * Datasets are reproducible for each seed, on every platform. */
+static uint64_t
+next_random(uint64_t *state)
+{
+  assert(state != NULL);
+  assert(*state != 0);
+
+  *state ^= *state >> 12;
+  *state ^= *state << 25;
+  *state ^= *state >> 27;
+  return *state * 0x2545f4914f6cdd1dULL;
+}
+
+/* Return a pseudo-random number from 0 to limit - 1. */
+static size_t
+next_random_below(uint64_t *state, size_t limit)
+{
+  assert(limit > 0);
+
+  return (size_t)(next_random(state) % limit);
+}
+
+/* Corpus */
+
+/* Read the file at path, and append it to *corpus, which has *length bytes.
+ * Returns false if the file can't be read. */
+static bool
+read_corpus_file(const char *path, uint8_t **corpus, size_t *length)
+{
+  FILE *f = fopen(path, "rb");
+  if (f == NULL) {
+    return false;
+  }
+
+  long file_length = -1;
+  if (fseek(f, 0, SEEK_END) == 0) {
+    file_length = ftell(f);
+  }
+  if (file_length < 0 || fseek(f, 0, SEEK_SET) != 0) {
+    fclose(f);
+    return false;
+  }
+
+  *corpus = realloc(*corpus, *length + (size_t)file_length + 1);
+  assert(*corpus != NULL);
+
+  const size_t read = fread(*corpus + *length, 1, (size_t)file_length, f);
+  fclose(f);
+
+  if (read != (size_t)file_length) {
+    return false;
+  }
+
+  *length += read;
+  return true;
+}
+
+/* Dataset */
+
+/* Fill in sample as a sample of kind, using corpus for English samples. */
+static void
+make_sample(sample_t *sample, sample_kind_t kind, const uint8_t *corpus,
+            size_t corpus_length, uint64_t *random_state)
+{
+  assert(corpus_length > MAX_SAMPLE_LENGTH);
+
+  sample->kind = kind;
+  sample->key = (uint8_t)next_random_below(random_state, BYTE_VALUE_COUNT);
+  sample->length = (MIN_SAMPLE_LENGTH
+                    + next_random_below(random_state,
+                                        (MAX_SAMPLE_LENGTH
+                                         - MIN_SAMPLE_LENGTH + 1)));
+  sample->bytes = malloc(sample->length);
+  assert(sample->bytes != NULL);
+
+  const size_t offset = next_random_below(random_state,
+                                          corpus_length - sample->length);
+
+  for (size_t i = 0; i < sample->length; i++) {
+    const uint64_t r = next_random(random_state);
+
+    switch (kind) {
+      case SAMPLE_ENGLISH:
+        sample->bytes[i] = corpus[offset + i] ^ sample->key;
+        break;
+      case SAMPLE_RANDOM:
+        sample->bytes[i] = (uint8_t)r;
+        break;
+      case SAMPLE_BINARY:
+        /* Half zeroes, some 0xff, some small integers, and the rest
+         * uniform */
+        if (r % 8 < 4) {
+          sample->bytes[i] = 0;
+        } else if (r % 8 == 4) {
+          sample->bytes[i] = 0xff;
+        } else if (r % 8 < 7) {
+          sample->bytes[i] = (uint8_t)((r >> 8) % 32);
+        } else {
+          sample->bytes[i] = (uint8_t)(r >> 8);
+        }
+        break;
+    }
+  }
+}
+
+/* Evaluation */
+
+/* Return the current monotonic time, in seconds. */
+static double
+monotonic_seconds(void)
+{
+  struct timespec now;
+  int rv = clock_gettime(CLOCK_MONOTONIC, &now);
+  assert(rv == 0);
+  (void)rv;
+
+  return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+/* Score sample XORed with every key using model, and place the results in
+ * scores_out. scores_out[key] is the score for key.
+ * Most models score every key from the sample's histogram. Histograms don't
+ * record byte order, so the n-gram model scores each decryption. */
+static void
+score_sample_all_keys(const sample_t *sample, score_model_id_t model,
+                      double scores_out[BYTE_VALUE_COUNT])
+{
+  if (model != SCORE_MODEL_ENGLISH_NGRAM) {
+    byte_histogram_t histogram;
+    byte_histogram_clear(&histogram);
+    byte_histogram_add_bytes(&histogram, sample->bytes, sample->length);
+
+    score_histogram_all_keys_model(&histogram, model, scores_out);
+    return;
+  }
+
+  bytearray_t *plaintext = bytearray_alloc(sample->length);
+  uint8_t *plaintext_bytes = bytearray_pointer_checked(plaintext, 0,
+                                                       sample->length);
+
+  for (size_t key = 0; key < BYTE_VALUE_COUNT; key++) {
+    const uint8_t key_byte = (uint8_t)key;
+    xor_repeat_bytes(plaintext_bytes, sample->bytes, sample->length,
+                     &key_byte, 1);
+    scores_out[key] = score_text_model(plaintext, model);
+  }
+
+  bytearray_free(plaintext);
+}
+
+/* Score every key for every sample using model, and place the best key and
+ * score for each sample in results_out.
+ * Returns the number of candidates (keys) scored per second. */
+static double
+run_model(const sample_t *samples, size_t sample_count,
+          score_model_id_t model, sample_result_t *results_out)
+{
+  const double start = monotonic_seconds();
+
+  for (size_t i = 0; i < sample_count; i++) {
+    double scores[BYTE_VALUE_COUNT];
+    score_sample_all_keys(&samples[i], model, scores);
+
+    /* Ties go to the lowest key */
+    results_out[i].key = 0;
+    results_out[i].score = scores[0];
+    for (size_t key = 1; key < BYTE_VALUE_COUNT; key++) {
+      if (scores[key] > results_out[i].score) {
+        results_out[i].key = (uint8_t)key;
+        results_out[i].score = scores[key];
+      }
+    }
+  }
+
+  const double elapsed = monotonic_seconds() - start;
+  const double candidates = (double)sample_count * BYTE_VALUE_COUNT;
+
+  return elapsed > 0.0 ? candidates / elapsed : INFINITY;
+}
+
+/* Print a table row for model at each of its thresholds, using the
+ * results from run_model(). */
+static void
+print_model_rows(const char *model_name, const double *thresholds,
+                 const sample_t *samples, size_t sample_count,
+                 const sample_result_t *results,
+                 double candidates_per_second)
+{
+  for (size_t t = 0; t < THRESHOLD_COUNT; t++) {
+    size_t positives = 0;
+    size_t true_positives = 0;
+    size_t false_positives = 0;
+    size_t recovered = 0;
+
+    for (size_t i = 0; i < sample_count; i++) {
+      const bool is_english = (samples[i].kind == SAMPLE_ENGLISH);
+      const bool is_detected = (results[i].score >= thresholds[t]);
+
+      positives += is_english;
+      true_positives += is_english && is_detected;
+      false_positives += !is_english && is_detected;
+      recovered += (is_english && is_detected
+                    && results[i].key == samples[i].key);
+    }
+
+    const size_t detected = true_positives + false_positives;
+    const double precision = (detected > 0
+                              ? (double)true_positives / (double)detected
+                              : 1.0);
+    const double recall = (positives > 0
+                           ? (double)true_positives / (double)positives
+                           : 0.0);
+    const double key_recovery = (positives > 0
+                                 ? (double)recovered / (double)positives
+                                 : 0.0);
+
+    printf("%s\t%.3f\t%zu\t%zu\t%zu\t%zu\t%.4f\t%.4f\t%.4f\t%.0f\n",
+           model_name, thresholds[t], positives, sample_count - positives,
+           true_positives, false_positives, precision, recall, key_recovery,
+           candidates_per_second);
+  }
+}
+
+int
+main(int argc, const char * argv[])
+{
+  size_t english_count = DEFAULT_SAMPLE_COUNT;
+  uint64_t seed = DEFAULT_SEED;
+  int first_corpus = 1;
+
+  while (first_corpus + 1 < argc && argv[first_corpus][0] == '-') {
+    const char *option = argv[first_corpus];
+    const char *value = argv[first_corpus + 1];
+
+    if (strcmp(option, "-n") == 0) {
+      english_count = strtoul(value, NULL, 10);
+    } else if (strcmp(option, "-s") == 0) {
+      seed = strtoull(value, NULL, 10);
+    } else {
+      break;
+    }
+
+    first_corpus += 2;
+  }
+
+  if (first_corpus >= argc || english_count == 0 || seed == 0) {
+    fprintf(stderr, USAGE);
+    return 1;
+  }
+
+  /* Load the English corpus */
+  uint8_t *corpus = NULL;
+  size_t corpus_length = 0;
+
+  for (int i = first_corpus; i < argc; i++) {
+    if (!read_corpus_file(argv[i], &corpus, &corpus_length)) {
+      fprintf(stderr, "Can't read corpus file: %s\n", argv[i]);
+      free(corpus);
+      return 1;
+    }
+  }
+
+  if (corpus_length <= MAX_SAMPLE_LENGTH) {
+    fprintf(stderr, "Corpus is too short: %zu bytes\n", corpus_length);
+    free(corpus);
+    return 1;
+  }
+
+  /* Build the labeled dataset */
+  const size_t sample_count = english_count * 2;
+  sample_t *samples = calloc(sample_count, sizeof(*samples));
+  assert(samples != NULL);
+  uint64_t random_state = seed;
+
+  for (size_t i = 0; i < sample_count; i++) {
+    sample_kind_t kind = SAMPLE_ENGLISH;
+    if (i >= english_count) {
+      kind = (i % 2 == 0) ? SAMPLE_RANDOM : SAMPLE_BINARY;
+    }
+    make_sample(&samples[i], kind, corpus, corpus_length, &random_state);
+  }
+
+  free(corpus);
+
+  /* Evaluate each model */
+  sample_result_t *results = calloc(sample_count, sizeof(*results));
+  assert(results != NULL);
+
+  printf("model\tthreshold\tpositives\tdecoys\ttrue_positives"
+         "\tfalse_positives\tprecision\trecall\tkey_recovery"
+         "\tcandidates_per_second\n");
+
+  const bool has_ngram_model = score_load_ngram_model(
+                                                    NGRAM_MODEL_DEFAULT_PATH);
+
+  for (size_t i = 0; i < SCORE_MODEL_COUNT; i++) {
+    const score_model_id_t model = (score_model_id_t)i;
+
+    if (model == SCORE_MODEL_ENGLISH_NGRAM && !has_ngram_model) {
+      fprintf(stderr, "Skipping %s: can't load %s\n",
+              score_model_get(model)->name, NGRAM_MODEL_DEFAULT_PATH);
+      continue;
+    }
+
+    /* Every other model's score is a mean log2 probability */
+    const double *thresholds = log_likelihood_thresholds;
+    if (model == SCORE_MODEL_ENGLISH_HEURISTIC) {
+      thresholds = heuristic_thresholds;
+    } else if (model == SCORE_MODEL_ENGLISH_NGRAM) {
+      thresholds = ngram_thresholds;
+    }
+
+    const double rate = run_model(samples, sample_count, model, results);
+    print_model_rows(score_model_get(model)->name, thresholds, samples,
+                     sample_count, results, rate);
+  }
+
+  for (size_t i = 0; i < sample_count; i++) {
+    free(samples[i].bytes);
+  }
+  free(samples);
+  free(results);
+
+  return 0;
+}